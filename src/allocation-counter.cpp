@@ -0,0 +1,32 @@
+#include "allocation-counter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Number of times that memory has been allocated with new since the program started
+static std::atomic<uint64_t> allocationCount(0);
+
+uint64_t getAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+// Counts every allocation. A size of 0 still has to return a unique pointer
+
+void* operator new(const size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(std::max<size_t>(size, 1));
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const size_t) noexcept {
+    std::free(memory);
+}
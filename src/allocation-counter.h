@@ -0,0 +1,13 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+// Allocation Counter
+// Replaces the global operator new and operator delete so that benchmarks can count how many times
+// memory is allocated on the heap. Only the frontend links it in, so programs that embed
+// libnescore keep their own allocator
+
+uint64_t getAllocationCount();
+
+#endif
@@ -24,6 +24,14 @@ void APU::writeRegister(const uint16_t addr, const uint8_t val) {
     registers[localAddr] = val;
 }
 
+void APU::saveState(StateWriter& writer) const {
+    writer.write(registers);
+}
+
+void APU::loadState(StateReader& reader) {
+    reader.read(registers);
+}
+
 // Private Member Functions
 
 // Maps the CPU address to the APU's local field, registers
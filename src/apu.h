@@ -5,6 +5,8 @@
 #include <cstring>
 #include <iostream>
 
+#include "save-state.h"
+
 // Audio Processing Unit
 // Handles anything related to audio. Stores data for addresses $4000 - $4013, $4015, and $4017 in
 // the CPU memory map. Note: the APU is not implemented yet
@@ -15,6 +17,8 @@ class APU {
         void clear();
         uint8_t readRegister(const uint16_t addr) const;
         void writeRegister(const uint16_t addr, const uint8_t val);
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
 
     private:
         uint8_t registers[0x16]; // APU registers in the CPU memory map
@@ -0,0 +1,158 @@
+#include "batch-runner.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// std::max takes it by reference, so it needs a definition outside of the class
+const size_t BatchRunner::cacheLineSize;
+
+// Public Member Functions
+
+// Loads every instance from the same ROM image, so the ROM is only in memory once no matter how
+// many instances there are. threadCount includes the thread that calls runFrame. The image's mapper
+// has to be supported (NESCore::isSupported)
+
+BatchRunner::BatchRunner(const std::shared_ptr<const ROMImage>& rom,
+        const unsigned int instanceCount, const unsigned int threadCount,
+        const unsigned int observation) :
+        observation(observation),
+        observationSize(0x800),
+        observationStride(0),
+        observations(nullptr),
+        threadCount(std::max(threadCount, 1u)),
+        generation(0),
+        busyWorkers(0),
+        stopping(false) {
+    if (observation == FrameObservations) {
+        observationSize = NESCore::frameWidth * NESCore::frameHeight * sizeof(uint32_t);
+    }
+    observationStride = (observationSize + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+    // aligned_alloc needs the size to be a multiple of the alignment, which the stride already is
+    observations = (uint8_t*) std::aligned_alloc(cacheLineSize, std::max(observationStride *
+        instanceCount, cacheLineSize));
+    if (observations == nullptr) {
+        std::cerr << "Could not allocate the observations\n";
+        exit(1);
+    }
+    memset(observations, 0, observationStride * instanceCount);
+
+    for (unsigned int i = 0; i < instanceCount; ++i) {
+        instances.push_back(std::make_unique<NESCore>());
+        instances[i]->load(rom);
+        if (observation == FrameObservations) {
+            instances[i]->setFrameBuffer((uint32_t*) (observations + i * observationStride),
+                NESCore::frameWidth * sizeof(uint32_t));
+        }
+    }
+
+    queues = std::make_unique<WorkQueue[]>(this->threadCount);
+    for (unsigned int i = 1; i < this->threadCount; ++i) {
+        workers.emplace_back(&BatchRunner::work, this, i);
+    }
+}
+
+BatchRunner::~BatchRunner() {
+    stopping = true;
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::free(observations);
+}
+
+// Sets which buttons are held on the joystick in the given port of the given instance. Takes
+// effect on the next call to runFrame
+
+void BatchRunner::setInput(const unsigned int instance, const unsigned int port,
+        const uint8_t mask) {
+    instances[instance]->setInput(port, mask);
+}
+
+// Runs every instance for one frame and updates their observations. Returns once all of them are
+// done
+
+void BatchRunner::runFrame() {
+    const unsigned int instanceCount = instances.size();
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        queues[i].next.store(i * instanceCount / threadCount, std::memory_order_relaxed);
+        queues[i].end = (i + 1) * instanceCount / threadCount;
+    }
+    busyWorkers.store(threadCount - 1, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    runInstances(0);
+
+    unsigned int busy = busyWorkers.load(std::memory_order_acquire);
+    while (busy != 0) {
+        busyWorkers.wait(busy, std::memory_order_acquire);
+        busy = busyWorkers.load(std::memory_order_acquire);
+    }
+}
+
+// Returns the observations of all instances. Instance i's observation starts at
+// i * getObservationStride()
+
+const uint8_t* BatchRunner::getObservations() const {
+    return observations;
+}
+
+size_t BatchRunner::getObservationStride() const {
+    return observationStride;
+}
+
+NESCore& BatchRunner::getInstance(const unsigned int instance) {
+    return *instances[instance];
+}
+
+unsigned int BatchRunner::getInstanceCount() const {
+    return instances.size();
+}
+
+unsigned int BatchRunner::getThreadCount() const {
+    return threadCount;
+}
+
+// Private Member Functions
+
+// Main loop of the worker threads. Sleeps until runFrame starts the next frame
+
+void BatchRunner::work(const unsigned int worker) {
+    unsigned int currentGeneration = 0;
+    while (true) {
+        generation.wait(currentGeneration, std::memory_order_acquire);
+        currentGeneration = generation.load(std::memory_order_acquire);
+        if (stopping) {
+            return;
+        }
+        runInstances(worker);
+        if (busyWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            busyWorkers.notify_one();
+        }
+    }
+}
+
+// Runs the instances in the worker's own queue, and then steals the rest of the other workers'
+// instances, starting with the next worker's queue
+
+void BatchRunner::runInstances(const unsigned int worker) {
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        WorkQueue& queue = queues[(worker + i) % threadCount];
+        unsigned int instance = queue.next.fetch_add(1, std::memory_order_relaxed);
+        while (instance < queue.end) {
+            runInstance(instance);
+            instance = queue.next.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void BatchRunner::runInstance(const unsigned int instance) {
+    instances[instance]->runFrame();
+    if (observation == RAMObservations) {
+        memcpy(observations + instance * observationStride,
+            instances[instance]->getRAM(), observationSize);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "nes-core.h"
+
+// Batch Runner
+// Runs many independent instances of the same ROM a frame at a time, e.g., for reinforcement
+// learning environments. Each frame, the instances are split evenly across a pool of worker
+// threads, and a worker that runs out of its own instances steals the remaining ones of the other
+// workers. Every instance reads the ROM out of the same ROM image. The observation of every
+// instance (its frame or its RAM) ends up in one contiguous array where each instance's observation
+// starts on its own cache line
+
+class BatchRunner {
+    public:
+        // What each instance's observation is
+        enum Observation {
+            // The finished frame as 256 x 240 ARGB pixels. The PPU converts it straight into the
+            // observation array
+            FrameObservations,
+            // All 2 KB of the RAM, copied after the frame is finished
+            RAMObservations
+        };
+
+        BatchRunner(const std::shared_ptr<const ROMImage>& rom, const unsigned int instanceCount,
+            const unsigned int threadCount, const unsigned int observation);
+        ~BatchRunner();
+        void setInput(const unsigned int instance, const unsigned int port, const uint8_t mask);
+        void runFrame();
+
+        // Getters
+        const uint8_t* getObservations() const;
+        size_t getObservationStride() const;
+        NESCore& getInstance(const unsigned int instance);
+        unsigned int getInstanceCount() const;
+        unsigned int getThreadCount() const;
+
+    private:
+        static const size_t cacheLineSize = 64;
+
+        // Instances that a worker runs before it steals from other workers. Claimed one at a time
+        // by incrementing next, both by the worker and by thieves. Each queue has its own cache
+        // line so that claiming from one queue doesn't slow down the others
+        struct alignas(cacheLineSize) WorkQueue {
+            std::atomic<unsigned int> next;
+            unsigned int end;
+        };
+
+        // The emulated machines. Each one is on the heap since it's hundreds of KB
+        std::vector<std::unique_ptr<NESCore>> instances;
+        // Depends on enum Observation
+        unsigned int observation;
+        // Number of bytes in one instance's observation
+        size_t observationSize;
+        // Number of bytes from the start of one instance's observation to the start of the next.
+        // observationSize rounded up to a multiple of the cache line size
+        size_t observationStride;
+        // Observations of every instance, one after another. Aligned to a cache line
+        uint8_t* observations;
+        // Queue of each worker. Worker 0 is the thread that calls runFrame
+        std::unique_ptr<WorkQueue[]> queues;
+        unsigned int threadCount;
+        // Threads of workers 1 and up
+        std::vector<std::thread> workers;
+        // Incremented to start the workers on the next frame
+        std::atomic<unsigned int> generation;
+        // Number of workers other than worker 0 that haven't finished the current frame
+        std::atomic<unsigned int> busyWorkers;
+        // Set to make the workers exit
+        std::atomic<bool> stopping;
+
+        void work(const unsigned int worker);
+        void runInstances(const unsigned int worker);
+        void runInstance(const unsigned int instance);
+};
+
+#endif
@@ -78,4 +78,56 @@ void CPUOp::clearDMA() {
 
 bool CPUOp::crossedPageBoundary() const {
     return tempAddr != fixedAddr;
-}
\ No newline at end of file
+}
+
+void CPUOp::saveState(StateWriter& writer) const {
+    writer.write(inst);
+    writer.write(pc);
+    writer.write(opcode);
+    writer.write(operandLo);
+    writer.write(operandHi);
+    writer.write(val);
+    writer.write(tempAddr);
+    writer.write(fixedAddr);
+    writer.write(addrMode);
+    writer.write(instType);
+    writer.write(cycle);
+    writer.write(dmaCycle);
+    writer.write(modify);
+    writer.write(write);
+    writer.write(writeUnmodified);
+    writer.write(writeModified);
+    writer.write(irq);
+    writer.write(brk);
+    writer.write(nmi);
+    writer.write(reset);
+    writer.write(interruptPrologue);
+    writer.write(oamDMATransfer);
+    writer.write(done);
+}
+
+void CPUOp::loadState(StateReader& reader) {
+    reader.read(inst);
+    reader.read(pc);
+    reader.read(opcode);
+    reader.read(operandLo);
+    reader.read(operandHi);
+    reader.read(val);
+    reader.read(tempAddr);
+    reader.read(fixedAddr);
+    reader.read(addrMode);
+    reader.read(instType);
+    reader.read(cycle);
+    reader.read(dmaCycle);
+    reader.read(modify);
+    reader.read(write);
+    reader.read(writeUnmodified);
+    reader.read(writeModified);
+    reader.read(irq);
+    reader.read(brk);
+    reader.read(nmi);
+    reader.read(reset);
+    reader.read(interruptPrologue);
+    reader.read(oamDMATransfer);
+    reader.read(done);
+}
@@ -3,6 +3,8 @@
 
 #include <cstdint>
 
+#include "save-state.h"
+
 // CPU Operation
 // Holds info specific to the current operation (i.e., instructions, interrupt prologues, and DMA
 // transfers)
@@ -14,6 +16,8 @@ class CPUOp {
         void clearInterruptFlags();
         void clearDMA();
         bool crossedPageBoundary() const;
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
 
     private:
         // Instruction
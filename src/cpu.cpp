@@ -12,7 +12,52 @@ CPU::CPU() :
         totalCycles(0),
         endOfProgram(false),
         haltAtBrk(false),
-        mute(true) { }
+        mute(true),
+        breakpoint(0),
+        hasBreakpoint(false),
+        catchUpPPU(false),
+        pendingPPUCycles(0),
+        frameDoneDuringSync(false),
+        fastInstructions(false) {
+    updatePages();
+}
+
+// Copies another CPU along with the rest of the machine. The page tables are rebuilt since they
+// point into the RAM and MMC, which would otherwise still be the other CPU's
+
+CPU::CPU(const CPU& other) {
+    *this = other;
+}
+
+CPU& CPU::operator=(const CPU& other) {
+    if (this == &other) {
+        return *this;
+    }
+    pc = other.pc;
+    sp = other.sp;
+    a = other.a;
+    x = other.x;
+    y = other.y;
+    p = other.p;
+    op = other.op;
+    ram = other.ram;
+    ppu = other.ppu;
+    apu = other.apu;
+    io = other.io;
+    mmc = other.mmc;
+    totalCycles = other.totalCycles;
+    endOfProgram = other.endOfProgram;
+    haltAtBrk = other.haltAtBrk;
+    mute = other.mute;
+    breakpoint = other.breakpoint;
+    hasBreakpoint = other.hasBreakpoint;
+    catchUpPPU = other.catchUpPPU;
+    pendingPPUCycles = other.pendingPPUCycles;
+    frameDoneDuringSync = other.frameDoneDuringSync;
+    fastInstructions = other.fastInstructions;
+    updatePages();
+    return *this;
+}
 
 void CPU::clear() {
     pc = 0;
@@ -27,57 +72,52 @@ void CPU::clear() {
     apu.clear();
     io.clear();
     mmc.clear();
+    updatePages();
     totalCycles = 0;
     endOfProgram = false;
+    pendingPPUCycles = 0;
+    frameDoneDuringSync = false;
 }
 
 // Executes exactly one CPU cycle
 
-void CPU::step(SDL_Renderer* renderer, SDL_Texture* texture) {
-    // This if statement performs the 6502's pipelined fetch
-    if (op.done || totalCycles == 0) {
-        // Clear previous operation to set up the next operation. However, this doesn't clear
-        // interrupt or OAM DMA transfer statuses because they are triggered in the previous
-        // operation and must remain for the next operation in order for the interrupt or OAM DMA
-        // transfer to occur as the next operation
-        op.clear(false, false);
-        op.pc = pc;
+void CPU::step() {
+    runCycle();
+    syncPPU();
+}
 
-        // If any interrupts are flagged, start the interrupt prologue. Ignore IRQs if the Interrupt
-        // Disable flag is set. Note that the BRK instruction bypasses this by setting
-        // interruptPrologue in its function
-        if ((op.irq && !areInterruptsDisabled()) || op.nmi || op.reset) {
-            op.interruptPrologue = true;
-        // Otherwise, read in the first byte of the instruction and start it as the next operation
-        } else {
-            op.inst = read(pc);
-            op.opcode = op.inst;
-        }
-    }
+// Executes up to the given number of CPU cycles. Returns early if the PC reaches the breakpoint or
+// if the program ends
 
-    // Priority list of what to do next if there are multiple options
-    if (op.oamDMATransfer) {
-        oamDMATransfer();
-    } else if (op.interruptPrologue && op.reset) {
-        prepareReset();
-    } else if (op.interruptPrologue && op.nmi) {
-        prepareNMI();
-    } else if (op.interruptPrologue && op.irq) {
-        prepareIRQ();
-    } else {
-        // Use the opcode to look up in the addressing mode and opcode arrays to get the two
-        // relevant functions
-        (this->*addrModeArr[op.opcode])();
-        (this->*opcodeArr[op.opcode])();
-    }
+CPU::RunResult CPU::runCycles(const unsigned int cycles) {
+    return run<false>(cycles);
+}
+
+// Executes CPU cycles until the PPU finishes rendering the current frame. Returns early if the PC
+// reaches the breakpoint or if the program ends
+
+CPU::RunResult CPU::runFrame() {
+    return run<true>(UINT_MAX);
+}
 
-    // PPU executes 3 cycles for every CPU cycle
-    for (unsigned int i = 0; i < 3; ++i) {
-        ppu.step(mmc, renderer, texture, mute);
+// Executes CPU cycles until the current instruction, interrupt, or OAM DMA transfer is done. If it
+// has already been done, the next one is executed instead. Returns early if the program ends
+
+void CPU::runInstruction() {
+    if (!catchUpPPU || !fastInstructions || runFastInstruction(UINT_MAX) == 0) {
+        do {
+            runCycle();
+        } while (!op.done && !endOfProgram);
     }
+    syncPPU();
+}
 
-    ++op.cycle;
-    ++totalCycles;
+// Runs only the PPU for the given number of cycles while the CPU stays where it is. Used for
+// benchmarking the PPU on its own
+
+void CPU::runPPUCycles(const unsigned int cycles) {
+    syncPPU();
+    ppu.runCycles(cycles, mmc, mute);
 }
 
 void CPU::readInInst(const std::string& filename) {
@@ -85,25 +125,100 @@ void CPU::readInInst(const std::string& filename) {
     const uint16_t upperResetAddr = 0xfffd;
     // Addresses $4020 - $ffff belong in the cartridge, so pass it off to the MMC
     mmc.readInInst(filename);
+    updatePages();
     pc = (read(upperResetAddr) << 8) | read(lowerResetAddr);
 }
 
-void CPU::readInINES(const std::string& filename) {
-    // Addresses $4020 - $ffff belong in the cartridge, so pass it off to the MMC
-    mmc.readInINES(filename);
+// Maps an .NES file into memory and initializes the PC to the reset vector. Returns false with the
+// reason in error if the file isn't a .NES file that can be loaded, in which case the CPU is left
+// as it was
+
+bool CPU::readInINES(const std::string& filename, std::string& error) {
+    const std::shared_ptr<const ROMImage> image = ROMImage::fromFile(filename, error);
+    if (image == nullptr) {
+        return false;
+    }
+    if (!loadImage(image)) {
+        error = "Only mappers 0, 1, 2, 3, and 7 are supported";
+        return false;
+    }
     if (filename == "test/nestest/nestest.nes") {
         // Use this start PC for an automated run of nestest.nes
         pc = 0xc000;
-    } else {
-        const uint16_t lowerResetAddr = 0xfffc;
-        const uint16_t upperResetAddr = 0xfffd;
-        // In all other cases, initialize PC to the reset vector
-        pc = (read(upperResetAddr) << 8) | read(lowerResetAddr);
     }
+    return true;
 }
 
-void CPU::updateButton(const SDL_Event& event) {
-    io.updateButton(event);
+// Loads an .NES file that has already been turned into a ROM image, which can be shared with other
+// CPUs, and initializes the PC to the reset vector. Returns false without changing the CPU if the
+// image's mapper isn't supported
+
+bool CPU::loadImage(const std::shared_ptr<const ROMImage>& image) {
+    // Addresses $4020 - $ffff belong in the cartridge, so pass it off to the MMC
+    if (!mmc.loadImage(image)) {
+        return false;
+    }
+    updatePages();
+    const uint16_t lowerResetAddr = 0xfffc;
+    const uint16_t upperResetAddr = 0xfffd;
+    pc = (read(upperResetAddr) << 8) | read(lowerResetAddr);
+    return true;
+}
+
+// Saves the whole machine. The PPU is caught up first so that the state is the same whether or not
+// the PPU runs only when the CPU interacts with it. Options (e.g., the breakpoint and render mode)
+// aren't part of the state
+
+void CPU::saveState(StateWriter& writer) {
+    syncPPU();
+    writer.write(pc);
+    writer.write(sp);
+    writer.write(a);
+    writer.write(x);
+    writer.write(y);
+    writer.write(p);
+    op.saveState(writer);
+    ram.saveState(writer);
+    ppu.saveState(writer);
+    apu.saveState(writer);
+    io.saveState(writer);
+    mmc.saveState(writer);
+    writer.write(totalCycles);
+    writer.write(endOfProgram);
+    writer.write(frameDoneDuringSync);
+}
+
+// Loads a state that was saved with the same ROM loaded. Returns false if the state is for a
+// different ROM, is damaged, or is too short. The machine is partly loaded by then, so the caller
+// has to restore it
+
+bool CPU::loadState(StateReader& reader) {
+    reader.read(pc);
+    reader.read(sp);
+    reader.read(a);
+    reader.read(x);
+    reader.read(y);
+    reader.read(p);
+    op.loadState(reader);
+    ram.loadState(reader);
+    if (!ppu.loadState(reader)) {
+        return false;
+    }
+    apu.loadState(reader);
+    io.loadState(reader);
+    if (!mmc.loadState(reader)) {
+        return false;
+    }
+    reader.read(totalCycles);
+    reader.read(endOfProgram);
+    reader.read(frameDoneDuringSync);
+    pendingPPUCycles = 0;
+    updatePages();
+    return !reader.hasFailed();
+}
+
+void CPU::setButtons(const unsigned int port, const uint8_t mask) {
+    io.setButtons(port, mask);
 }
 
 // Compares the current registers and total cycles with a given CPU state
@@ -204,14 +319,26 @@ uint8_t CPU::readRAM(const uint16_t addr) const {
     return ram.read(addr);
 }
 
+const uint8_t* CPU::getRAM() const {
+    return ram.getData();
+}
+
 unsigned int CPU::getTotalPPUCycles() const {
-    return ppu.getTotalCycles();
+    return ppu.getTotalCycles() + pendingPPUCycles;
 }
 
 uint8_t CPU::readPRG(const uint16_t addr) const {
     return mmc.readPRG(addr);
 }
 
+const uint32_t* CPU::getFrameBuffer() const {
+    return ppu.getFrameBuffer();
+}
+
+bool CPU::isFastInstructions() const {
+    return fastInstructions;
+}
+
 void CPU::setHaltAtBrk(const bool h) {
     haltAtBrk = h;
 }
@@ -220,7 +347,78 @@ void CPU::setMute(const bool m) {
     mute = m;
 }
 
+void CPU::setCatchUpPPU(const bool c) {
+    syncPPU();
+    catchUpPPU = c;
+}
+
+// Fast instructions are only executed while catching the PPU up, so enabling them enables that too
+
+void CPU::setFastInstructions(const bool f) {
+    fastInstructions = f;
+    if (f) {
+        setCatchUpPPU(true);
+    }
+}
+
+// Depends on enum PPU::RenderMode
+
+void CPU::setPPURenderMode(const unsigned int mode) {
+    syncPPU();
+    ppu.setRenderMode(mode);
+}
+
+void CPU::setFrameBuffer(uint32_t* pixels, const unsigned int pitch) {
+    syncPPU();
+    ppu.setFrameBuffer(pixels, pitch);
+}
+
+void CPU::setFrameOutput(const bool output) {
+    syncPPU();
+    ppu.setFrameOutput(output);
+}
+
+// Applies an option from the command line. ppu=catchup runs the PPU only when the CPU interacts
+// with it, and ppu=eager runs the PPU on every CPU cycle (the default). cpu=fast executes
+// instructions that don't interact with other components in one go (which also enables
+// ppu=catchup), and cpu=cycle executes every instruction cycle by cycle (the default).
+// render=scanline outputs a whole scanline at once, and render=dot outputs every pixel on its own
+// cycle (the default). Returns false if it isn't a CPU option
+
+bool CPU::setOption(const std::string& option) {
+    if (option == "ppu=catchup") {
+        setCatchUpPPU(true);
+        return true;
+    } else if (option == "ppu=eager") {
+        setCatchUpPPU(false);
+        return true;
+    } else if (option == "cpu=fast") {
+        setFastInstructions(true);
+        return true;
+    } else if (option == "cpu=cycle") {
+        setFastInstructions(false);
+        return true;
+    } else if (option == "render=scanline") {
+        setPPURenderMode(PPU::ScanlineRendering);
+        return true;
+    } else if (option == "render=dot") {
+        setPPURenderMode(PPU::DotRendering);
+        return true;
+    }
+    return false;
+}
+
+void CPU::setBreakpoint(const uint16_t addr) {
+    breakpoint = addr;
+    hasBreakpoint = true;
+}
+
+void CPU::clearBreakpoint() {
+    hasBreakpoint = false;
+}
+
 void CPU::clearTotalPPUCycles() {
+    syncPPU();
     ppu.clearTotalCycles();
 }
 
@@ -284,8 +482,8 @@ void CPU::printUnknownOp() const {
 
 // Prints out the current state in the style of nestest.log
 
-void CPU::printStateInst(const uint32_t inst) const {
-    std::cout << std::hex << (unsigned int) pc << "  " << (unsigned int) inst << "  A:" <<
+void CPU::printStateInst(const uint32_t inst, std::ostream& out) const {
+    out << std::hex << (unsigned int) pc << "  " << (unsigned int) inst << "  A:" <<
         (unsigned int) a << " X:" << (unsigned int) x << " Y:" << (unsigned int) y << " P:" <<
         (unsigned int) p << " SP:" << (unsigned int) sp << " CYC:" << std::dec << totalCycles <<
         "\n";
@@ -297,13 +495,444 @@ void CPU::printPPU() const {
 
 // Private Member Functions
 
+// Cycle Execution
+
+// Executes exactly one CPU cycle. Returns true if the PPU finished rendering a frame during the
+// cycle
+
+inline bool CPU::runCycle() {
+    // This if statement performs the 6502's pipelined fetch
+    if (op.done || totalCycles == 0) {
+        // Clear previous operation to set up the next operation. However, this doesn't clear
+        // interrupt or OAM DMA transfer statuses because they are triggered in the previous
+        // operation and must remain for the next operation in order for the interrupt or OAM DMA
+        // transfer to occur as the next operation
+        op.clear(false, false);
+        op.pc = pc;
+
+        // If any interrupts are flagged, start the interrupt prologue. Ignore IRQs if the Interrupt
+        // Disable flag is set. Note that the BRK instruction bypasses this by setting
+        // interruptPrologue in its function
+        if ((op.irq && !areInterruptsDisabled()) || op.nmi || op.reset) {
+            op.interruptPrologue = true;
+        // Otherwise, read in the first byte of the instruction and start it as the next operation
+        } else {
+            op.inst = read(pc);
+            op.opcode = op.inst;
+            const InstDescriptor& descriptor = instDescriptors[op.opcode];
+            op.addrMode = descriptor.addrMode;
+            op.instType = descriptor.instType;
+        }
+    }
+
+    // Priority list of what to do next if there are multiple options
+    if (op.oamDMATransfer) {
+        oamDMATransfer();
+    } else if (op.interruptPrologue && op.reset) {
+        prepareReset();
+    } else if (op.interruptPrologue && op.nmi) {
+        prepareNMI();
+    } else if (op.interruptPrologue && op.irq) {
+        prepareIRQ();
+    } else {
+        // Use the opcode to look up the function that runs both the addressing mode and operation
+        // functions of the opcode
+        (this->*instDescriptors[op.opcode].execute)();
+    }
+
+    // PPU executes 3 cycles for every CPU cycle. When catching up, they're only counted here and
+    // executed once the CPU interacts with the PPU
+    bool frameDone = false;
+    if (catchUpPPU) {
+        pendingPPUCycles += 3;
+    } else {
+        frameDone = ppu.runCycles(3, mmc, mute);
+    }
+
+    ++op.cycle;
+    ++totalCycles;
+    return frameDone;
+}
+
+// Runs the addressing mode function and then the operation function of an opcode. Each entry in
+// instDescriptors points to one of these, so the compiler can inline both functions into one
+
+template <CPU::funcPtr addrModeFunc, CPU::funcPtr opFunc>
+void CPU::execute() {
+    (this->*addrModeFunc)();
+    (this->*opFunc)();
+}
+
+// Shared loop of runCycles and runFrame. The loop state is kept in locals so that the only work
+// done between cycles is checking for the events that end the run
+
+template <bool stopAtFrameEnd>
+CPU::RunResult CPU::run(unsigned int cycles) {
+    const bool checkBreakpoint = hasBreakpoint;
+    const uint16_t breakpointPC = breakpoint;
+    if (!catchUpPPU) {
+        for (; cycles > 0; --cycles) {
+            const bool frameDone = runCycle();
+            if (endOfProgram) {
+                return ProgramEnded;
+            }
+            if (checkBreakpoint && pc == breakpointPC) {
+                return BreakpointHit;
+            }
+            if (stopAtFrameEnd && frameDone) {
+                return FrameDone;
+            }
+        }
+        return BudgetReached;
+    }
+
+    // When catching up, the PPU only reports that the frame is done after it's caught up, so it's
+    // caught up on the earliest cycle that it could render the frame, and then on every cycle after
+    // that until it does
+    frameDoneDuringSync = false;
+    unsigned int cyclesUntilFrameCheck = getCyclesUntilFrameCheck();
+    RunResult result = BudgetReached;
+    while (cycles > 0) {
+        // Instructions executed in one go must end before the next frame check so that the frame
+        // is still checked for on the same cycles
+        if (fastInstructions) {
+            unsigned int maxCycles = cycles;
+            if (stopAtFrameEnd && cyclesUntilFrameCheck - 1 < maxCycles) {
+                maxCycles = cyclesUntilFrameCheck - 1;
+            }
+            const unsigned int instCycles = runFastInstruction(maxCycles);
+            if (instCycles > 0) {
+                cycles -= instCycles;
+                cyclesUntilFrameCheck -= instCycles;
+                continue;
+            }
+        }
+        runCycle();
+        --cycles;
+        if (endOfProgram) {
+            result = ProgramEnded;
+            break;
+        }
+        if (checkBreakpoint && pc == breakpointPC) {
+            result = BreakpointHit;
+            break;
+        }
+        if (stopAtFrameEnd && --cyclesUntilFrameCheck == 0) {
+            syncPPU();
+            if (frameDoneDuringSync) {
+                result = FrameDone;
+                break;
+            }
+            cyclesUntilFrameCheck = getCyclesUntilFrameCheck();
+        }
+    }
+    // Leave the PPU caught up so that its state is accurate between runs
+    syncPPU();
+    return result;
+}
+
+// PPU Catch-Up
+
+// Runs the PPU for the cycles that it's behind the CPU by. Called before the CPU interacts with the
+// PPU, which includes reading and writing to its registers, OAM DMA transfers, writes to the MMC
+// that can change the pattern tables or mirroring, and polling for an NMI that could be active
+
+void CPU::syncPPU() {
+    if (pendingPPUCycles > 0) {
+        if (ppu.runCycles(pendingPPUCycles, mmc, mute)) {
+            frameDoneDuringSync = true;
+        }
+        pendingPPUCycles = 0;
+    }
+}
+
+// Returns the number of CPU cycles until the earliest cycle that the PPU could render the frame on
+
+unsigned int CPU::getCyclesUntilFrameCheck() const {
+    // The frame is rendered on the cycle after the cycles returned by getCyclesUntilFrameEnd
+    const unsigned int ppuCycles = ppu.getCyclesUntilFrameEnd() + 1;
+    if (ppuCycles <= pendingPPUCycles) {
+        return 1;
+    }
+    return (ppuCycles - pendingPPUCycles + 2) / 3;
+}
+
+// Fast Instructions
+
+// Executes the next instruction in one go and returns the number of cycles that it took. This is
+// only done when nothing could happen in the middle of the instruction that would make the result
+// differ from executing it cycle by cycle: it only accesses memory that doesn't interact with other
+// components, no NMI could be polled during it, it fits within the given number of cycles, and the
+// PC doesn't pass the breakpoint. Otherwise, nothing is changed and 0 is returned so that the
+// instruction is executed cycle by cycle instead
+
+unsigned int CPU::runFastInstruction(const unsigned int maxCycles) {
+    if ((!op.done && totalCycles != 0) || op.irq || op.nmi || op.reset || op.oamDMATransfer ||
+            !isFastReadable(pc)) {
+        return 0;
+    }
+    const uint8_t opcode = read(pc);
+    const InstDescriptor& descriptor = instDescriptors[opcode];
+    const unsigned int length = getInstLength(descriptor.addrMode);
+    uint8_t operandLo = 0;
+    uint8_t operandHi = 0;
+    if (length >= 2) {
+        if (!isFastReadable(pc + 1)) {
+            return 0;
+        }
+        operandLo = read(pc + 1);
+    }
+    if (length == 3) {
+        if (!isFastReadable(pc + 2)) {
+            return 0;
+        }
+        operandHi = read(pc + 2);
+    }
+    uint16_t nextPC = pc + length;
+
+    // Calculate the address that the instruction operates on along with the address before its
+    // high byte is fixed, which is the same as the addressing mode functions
+    uint16_t tempAddr = 0;
+    uint16_t fixedAddr = 0;
+    uint8_t pointer;
+    uint16_t baseAddr;
+    switch (descriptor.addrMode) {
+        case CPUOp::Absolute:
+        case CPUOp::Indirect:
+            tempAddr = (operandHi << 8) | operandLo;
+            fixedAddr = tempAddr;
+            break;
+        case CPUOp::AbsoluteX:
+            tempAddr = (operandHi << 8) | (uint8_t) (operandLo + x);
+            fixedAddr = ((operandHi << 8) | operandLo) + x;
+            break;
+        case CPUOp::AbsoluteY:
+            tempAddr = (operandHi << 8) | (uint8_t) (operandLo + y);
+            fixedAddr = ((operandHi << 8) | operandLo) + y;
+            break;
+        case CPUOp::IndirectX:
+            // The pointer wraps around within the zero page, which is always in RAM
+            pointer = operandLo + x;
+            tempAddr = read(pointer) | (read((uint8_t) (pointer + 1)) << 8);
+            fixedAddr = tempAddr;
+            break;
+        case CPUOp::IndirectY:
+            baseAddr = read(operandLo) | (read((uint8_t) (operandLo + 1)) << 8);
+            tempAddr = (baseAddr & 0xff00) | (uint8_t) (baseAddr + y);
+            fixedAddr = baseAddr + y;
+            break;
+        case CPUOp::Relative:
+            tempAddr = nextPC + (int8_t) operandLo;
+            fixedAddr = tempAddr;
+            break;
+        case CPUOp::ZeroPage:
+            tempAddr = operandLo;
+            fixedAddr = tempAddr;
+            break;
+        case CPUOp::ZeroPageX:
+            tempAddr = (uint8_t) (operandLo + x);
+            fixedAddr = tempAddr;
+            break;
+        case CPUOp::ZeroPageY:
+            tempAddr = (uint8_t) (operandLo + y);
+            fixedAddr = tempAddr;
+    }
+
+    unsigned int cycles = descriptor.cycles;
+    const uint16_t stackStart = 0x100;
+    uint16_t indirectLo;
+    uint16_t indirectHi;
+    switch (opcode) {
+        case 0x20:
+            // JSR
+            nextPC = tempAddr;
+            break;
+        case 0x40:
+            // RTI. The P register is pulled before the PC
+            nextPC = ram.read(stackStart | (uint8_t) (sp + 2)) |
+                (ram.read(stackStart | (uint8_t) (sp + 3)) << 8);
+            break;
+        case 0x4c:
+            // JMP absolute
+            nextPC = tempAddr;
+            break;
+        case 0x60:
+            // RTS
+            nextPC = (ram.read(stackStart | (uint8_t) (sp + 1)) |
+                (ram.read(stackStart | (uint8_t) (sp + 2)) << 8)) + 1;
+            break;
+        case 0x6c:
+            // JMP indirect. The pointer doesn't cross the page boundary when reading the high byte,
+            // and the target address is read from as well
+            indirectLo = tempAddr;
+            indirectHi = (tempAddr & 0xff00) | (uint8_t) (tempAddr + 1);
+            if (!isFastReadable(indirectLo) || !isFastReadable(indirectHi)) {
+                return 0;
+            }
+            nextPC = read(indirectLo) | (read(indirectHi) << 8);
+            if (!isFastReadable(nextPC)) {
+                return 0;
+            }
+            break;
+        case 0x08:
+        case 0x28:
+        case 0x48:
+        case 0x68:
+            // PHP, PLP, PHA, and PLA only access the stack
+            break;
+        default:
+            if (descriptor.addrMode == CPUOp::Relative) {
+                // Branch instructions take 1 extra cycle if the branch is taken and 1 more if the
+                // page boundary is crossed. Bits 6 - 7 of the opcode select the flag to test, and
+                // bit 5 is the value that the flag has to be for the branch to be taken
+                const uint8_t branchFlags[] = {Negative, Overflow, Carry, Zero};
+                const bool flagSet = p & branchFlags[opcode >> 6];
+                if (flagSet == (bool) (opcode & 0x20)) {
+                    ++cycles;
+                    if ((tempAddr & 0xff00) != (nextPC & 0xff00)) {
+                        ++cycles;
+                    }
+                    nextPC = tempAddr;
+                }
+            } else if (descriptor.instType != 0) {
+                // Read and read-modify-write instructions read from the address before its high
+                // byte is fixed and then the fixed address. Write instructions don't read
+                if (descriptor.addrMode != CPUOp::Immediate &&
+                        descriptor.instType != CPUOp::WriteInst && (!isFastReadable(tempAddr) ||
+                        !isFastReadable(fixedAddr))) {
+                    return 0;
+                }
+                if (descriptor.instType != CPUOp::ReadInst && !isFastWritable(fixedAddr)) {
+                    return 0;
+                }
+                if (tempAddr != fixedAddr) {
+                    cycles += descriptor.pageCrossPenalty;
+                }
+            } else if (descriptor.addrMode != CPUOp::Implied &&
+                    descriptor.addrMode != CPUOp::Accumulator) {
+                // Unsupported unofficial opcodes
+                return 0;
+            } else if (descriptor.operation == &CPU::brk || descriptor.operation == &CPU::stp) {
+                return 0;
+            }
+    }
+
+    if (cycles > maxCycles || ppu.isNMIPossible(pendingPPUCycles + cycles * 3)) {
+        return 0;
+    }
+    // The PC only takes on the values of the next 3 addresses and the address of the next
+    // instruction during an instruction, so these are the only values that could hit the
+    // breakpoint
+    const unsigned int maxInstLength = 3;
+    if (hasBreakpoint && ((uint16_t) (breakpoint - pc - 1) < maxInstLength ||
+            breakpoint == nextPC)) {
+        return 0;
+    }
+
+    // Set up the operation the same way as when it's executed cycle by cycle. The cycle is set
+    // past the first cycle since implied operations poll for interrupts on it
+    op.clear(false, false);
+    op.pc = pc;
+    op.opcode = opcode;
+    op.addrMode = descriptor.addrMode;
+    op.instType = descriptor.instType;
+    op.cycle = 1;
+    op.tempAddr = fixedAddr;
+    switch (opcode) {
+        case 0x08:
+            ram.push(sp, p, mute);
+            break;
+        case 0x20:
+            // The address of the last byte of JSR is pushed
+            ram.push(sp, (pc + 2) >> 8, mute);
+            ram.push(sp, (pc + 2) & 0xff, mute);
+            break;
+        case 0x28:
+            p = ram.pull(sp, mute) | Break | UnusedFlag;
+            break;
+        case 0x40:
+            p = ram.pull(sp, mute) | Break | UnusedFlag;
+            ram.pull(sp, mute);
+            ram.pull(sp, mute);
+            break;
+        case 0x48:
+            ram.push(sp, a, mute);
+            break;
+        case 0x60:
+            ram.pull(sp, mute);
+            ram.pull(sp, mute);
+            break;
+        case 0x68:
+            a = ram.pull(sp, mute);
+            updateZeroFlag(a);
+            updateNegativeFlag(a);
+            break;
+        case 0x4c:
+        case 0x6c:
+            break;
+        default:
+            if (descriptor.addrMode == CPUOp::Relative) {
+                break;
+            }
+            if (descriptor.addrMode == CPUOp::Immediate) {
+                op.val = operandLo;
+            } else if (descriptor.addrMode == CPUOp::Accumulator) {
+                op.val = a;
+            } else if (descriptor.instType == CPUOp::ReadInst ||
+                    descriptor.instType == CPUOp::RMWInst) {
+                op.val = read(fixedAddr);
+            }
+            op.modify = true;
+            op.write = true;
+            (this->*descriptor.operation)();
+            if (descriptor.instType == CPUOp::RMWInst) {
+                op.writeUnmodified = true;
+                (this->*descriptor.operation)();
+                op.writeModified = true;
+                (this->*descriptor.operation)();
+            }
+    }
+    pc = nextPC;
+    op.cycle = cycles;
+    op.done = true;
+    totalCycles += cycles;
+    pendingPPUCycles += cycles * 3;
+    return cycles;
+}
+
+// Returns the number of bytes that an instruction with the given addressing mode takes up
+
+unsigned int CPU::getInstLength(const unsigned int addrMode) {
+    switch (addrMode) {
+        case CPUOp::Accumulator:
+        case CPUOp::Implied:
+            return 1;
+        case CPUOp::Absolute:
+        case CPUOp::AbsoluteX:
+        case CPUOp::AbsoluteY:
+        case CPUOp::Indirect:
+            return 3;
+    }
+    return 2;
+}
+
+// Accesses to pages that are read from or written to directly (RAM, PRG-RAM, and PRG-ROM reads)
+// don't interact with other components, so they can be done at any point during an instruction
+
+bool CPU::isFastReadable(const uint16_t addr) const {
+    return readPages[addr >> 8] != nullptr;
+}
+
+bool CPU::isFastWritable(const uint16_t addr) const {
+    return writePages[addr >> 8] != nullptr;
+}
+
 // Addressing Modes
 // These functions prepare the operation functions as much as possible for execution
 
 void CPU::abs() {
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::Absolute;
             ++pc;
             break;
         case 1:
@@ -343,7 +972,6 @@ void CPU::abx() {
     uint8_t temp;
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::AbsoluteX;
             ++pc;
             break;
         case 1:
@@ -403,7 +1031,6 @@ void CPU::aby() {
     uint8_t temp;
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::AbsoluteY;
             ++pc;
             break;
         case 1:
@@ -462,7 +1089,6 @@ void CPU::aby() {
 void CPU::acc() {
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::Accumulator;
             pollInterrupts();
             ++pc;
             break;
@@ -475,7 +1101,6 @@ void CPU::acc() {
 void CPU::imm() {
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::Immediate;
             pollInterrupts();
             ++pc;
             break;
@@ -491,7 +1116,6 @@ void CPU::imm() {
 void CPU::imp() {
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::Implied;
             ++pc;
             // Polling for interrupts isn't done here because some implied instructions are 2 cycles
             // long and others are longer. At this point, the operation function hasn't been called
@@ -508,7 +1132,6 @@ void CPU::idr() {
     uint8_t temp;
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::Indirect;
             ++pc;
             break;
         case 1:
@@ -536,7 +1159,6 @@ void CPU::idx() {
     uint8_t temp;
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::IndirectX;
             ++pc;
             break;
         case 1:
@@ -579,7 +1201,6 @@ void CPU::idy() {
     uint8_t temp;
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::IndirectY;
             ++pc;
             break;
         case 1:
@@ -641,7 +1262,6 @@ void CPU::rel() {
     uint8_t temp;
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::Relative;
             ++pc;
             break;
         case 1:
@@ -678,7 +1298,6 @@ void CPU::rel() {
 void CPU::zpg() {
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::ZeroPage;
             ++pc;
             break;
         case 1:
@@ -710,7 +1329,6 @@ void CPU::zpx() {
     uint8_t temp;
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::ZeroPageX;
             ++pc;
             break;
         case 1:
@@ -747,7 +1365,6 @@ void CPU::zpy() {
     uint8_t temp;
     switch (op.cycle) {
         case 0:
-            op.addrMode = CPUOp::ZeroPageY;
             ++pc;
             break;
         case 1:
@@ -785,7 +1402,6 @@ void CPU::zpy() {
 // mode functions
 
 void CPU::adc() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         // Add in a 2-byte variable to see if the result becomes greater than 1 byte
         uint16_t temp = a + op.val + (p & Carry);
@@ -812,7 +1428,6 @@ void CPU::alr() {
 }
 
 void CPU::andOp() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         a &= op.val;
         updateZeroFlag(a);
@@ -832,10 +1447,6 @@ void CPU::arr() {
 }
 
 void CPU::asl() {
-    if (op.addrMode != CPUOp::Accumulator) {
-        op.instType = CPUOp::RMWInst;
-    }
-
     // If the addressing mode is accumulator, then this operation only operates on the accumulator
     // and doesn't read or write
     if (op.modify && op.addrMode == CPUOp::Accumulator) {
@@ -911,7 +1522,6 @@ void CPU::beq() {
 }
 
 void CPU::bit() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         uint8_t temp = a & op.val;
         setOverflowFlag(op.val & Overflow);
@@ -1049,7 +1659,6 @@ void CPU::clv() {
 }
 
 void CPU::cmp() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         uint8_t temp = a - op.val;
         setCarryFlag(a >= op.val);
@@ -1060,7 +1669,6 @@ void CPU::cmp() {
 }
 
 void CPU::cpx() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         uint8_t temp = x - op.val;
         setCarryFlag(x >= op.val);
@@ -1071,7 +1679,6 @@ void CPU::cpx() {
 }
 
 void CPU::cpy() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         uint8_t temp = y - op.val;
         setCarryFlag(y >= op.val);
@@ -1082,7 +1689,6 @@ void CPU::cpy() {
 }
 
 void CPU::dcp() {
-    op.instType = CPUOp::RMWInst;
     if (op.writeModified) {
         dec();
         cmp();
@@ -1092,7 +1698,6 @@ void CPU::dcp() {
 }
 
 void CPU::dec() {
-    op.instType = CPUOp::RMWInst;
     if (op.writeModified) {
         write(op.tempAddr, op.val);
         op.done = true;
@@ -1127,7 +1732,6 @@ void CPU::dey() {
 }
 
 void CPU::eor() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         a ^= op.val;
         updateZeroFlag(a);
@@ -1137,7 +1741,6 @@ void CPU::eor() {
 }
 
 void CPU::inc() {
-    op.instType = CPUOp::RMWInst;
     if (op.writeModified) {
         write(op.tempAddr, op.val);
         op.done = true;
@@ -1172,7 +1775,6 @@ void CPU::iny() {
 }
 
 void CPU::isc() {
-    op.instType = CPUOp::RMWInst;
     if (op.writeModified) {
         inc();
         sbc();
@@ -1227,7 +1829,6 @@ void CPU::las() {
 }
 
 void CPU::lax() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         a = op.val;
         x = op.val;
@@ -1238,7 +1839,6 @@ void CPU::lax() {
 }
 
 void CPU::lda() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         a = op.val;
         updateZeroFlag(a);
@@ -1248,7 +1848,6 @@ void CPU::lda() {
 }
 
 void CPU::ldx() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         x = op.val;
         updateZeroFlag(x);
@@ -1258,7 +1857,6 @@ void CPU::ldx() {
 }
 
 void CPU::ldy() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         y = op.val;
         updateZeroFlag(y);
@@ -1268,10 +1866,6 @@ void CPU::ldy() {
 }
 
 void CPU::lsr() {
-    if (op.addrMode != CPUOp::Accumulator) {
-        op.instType = CPUOp::RMWInst;
-    }
-
     // If the addressing mode is accumulator, then this operation only operates on the accumulator
     // and doesn't read or write
     if (op.modify && op.addrMode == CPUOp::Accumulator) {
@@ -1294,7 +1888,6 @@ void CPU::lsr() {
 }
 
 void CPU::nop() {
-    op.instType = CPUOp::ReadInst;
     if (op.cycle == 0 && op.addrMode == CPUOp::Implied) {
         pollInterrupts();
     } else if (op.modify) {
@@ -1303,7 +1896,6 @@ void CPU::nop() {
 }
 
 void CPU::ora() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         a |= op.val;
         updateZeroFlag(a);
@@ -1363,7 +1955,6 @@ void CPU::plp() {
 }
 
 void CPU::rla() {
-    op.instType = CPUOp::RMWInst;
     if (op.writeModified) {
         rol();
         andOp();
@@ -1373,10 +1964,6 @@ void CPU::rla() {
 }
 
 void CPU::rol() {
-    if (op.addrMode != CPUOp::Accumulator) {
-        op.instType = CPUOp::RMWInst;
-    }
-
     // If the addressing mode is accumulator, then this operation only operates on the accumulator
     // and doesn't read or write
     if (op.modify && op.addrMode == CPUOp::Accumulator) {
@@ -1407,10 +1994,6 @@ void CPU::rol() {
 }
 
 void CPU::ror() {
-    if (op.addrMode != CPUOp::Accumulator) {
-        op.instType = CPUOp::RMWInst;
-    }
-
     // If the addressing mode is accumulator, then this operation only operates on the accumulator
     // and doesn't read or write
     if (op.modify && op.addrMode == CPUOp::Accumulator) {
@@ -1441,7 +2024,6 @@ void CPU::ror() {
 }
 
 void CPU::rra() {
-    op.instType = CPUOp::RMWInst;
     if (op.writeModified) {
         ror();
         adc();
@@ -1482,7 +2064,6 @@ void CPU::rts() {
 }
 
 void CPU::sax() {
-    op.instType = CPUOp::WriteInst;
     if (op.write) {
         write(op.tempAddr, a & x);
         op.done = true;
@@ -1490,7 +2071,6 @@ void CPU::sax() {
 }
 
 void CPU::sbc() {
-    op.instType = CPUOp::ReadInst;
     if (op.modify) {
         op.val = 0xff - op.val;
         adc();
@@ -1535,7 +2115,6 @@ void CPU::shy() {
 }
 
 void CPU::slo() {
-    op.instType = CPUOp::RMWInst;
     if (op.writeModified) {
         asl();
         ora();
@@ -1545,7 +2124,6 @@ void CPU::slo() {
 }
 
 void CPU::sre() {
-    op.instType = CPUOp::RMWInst;
     if (op.writeModified) {
         lsr();
         eor();
@@ -1555,7 +2133,6 @@ void CPU::sre() {
 }
 
 void CPU::sta() {
-    op.instType = CPUOp::WriteInst;
     if (op.write) {
         write(op.tempAddr, a);
         op.done = true;
@@ -1568,7 +2145,6 @@ void CPU::stp() {
 }
 
 void CPU::stx() {
-    op.instType = CPUOp::WriteInst;
     if (op.write) {
         write(op.tempAddr, x);
         op.done = true;
@@ -1576,7 +2152,6 @@ void CPU::stx() {
 }
 
 void CPU::sty() {
-    op.instType = CPUOp::WriteInst;
     if (op.write) {
         write(op.tempAddr, y);
         op.done = true;
@@ -1657,9 +2232,38 @@ void CPU::xaa() {
     printUnknownOp();
 }
 
-// Passes the read to the component that is responsible for the address range in the CPU memory map
+// Reads from the page table if the address's page is stored in memory that can be read from
+// directly. Otherwise, the read is passed to the component that is responsible for it
 
 uint8_t CPU::read(const uint16_t addr) {
+    const uint8_t* page = readPages[addr >> 8];
+    if (page != nullptr) {
+        return page[addr & 0xff];
+    }
+    return readComponent(addr);
+}
+
+// Writes to the page table if the address's page is stored in memory that can be written to
+// directly. Otherwise, the write is passed to the component that is responsible for it
+
+void CPU::write(const uint16_t addr, const uint8_t val) {
+    uint8_t* page = writePages[addr >> 8];
+    if (page != nullptr) {
+        page[addr & 0xff] = val;
+    } else {
+        writeComponent(addr, val);
+    }
+
+    if (!mute) {
+        std::cout << std::hex << "0x" << (unsigned int) val << " has been written to the address 0x"
+            << (unsigned int) addr << "\n--------------------------------------------------\n" <<
+            std::dec;
+    }
+}
+
+// Passes the read to the component that is responsible for the address range in the CPU memory map
+
+uint8_t CPU::readComponent(const uint16_t addr) {
     const uint16_t ppuCtrl = 0x2000;
     const uint16_t sq1Vol = 0x4000;
     const uint16_t oamDMAAddr = 0x4014;
@@ -1669,6 +2273,7 @@ uint8_t CPU::read(const uint16_t addr) {
     if (addr < ppuCtrl) {
         return ram.read(addr);
     } else if (addr < sq1Vol || addr == oamDMAAddr) {
+        syncPPU();
         return ppu.readRegister(addr, mmc);
     } else if (addr < joy1) {
         return apu.readRegister(addr);
@@ -1683,7 +2288,7 @@ uint8_t CPU::read(const uint16_t addr) {
 
 // Passes the write to the component that is responsible for the address range in the CPU memory map
 
-void CPU::write(const uint16_t addr, const uint8_t val) {
+void CPU::writeComponent(const uint16_t addr, const uint8_t val) {
     const uint16_t ppuCtrl = 0x2000;
     const uint16_t sq1Vol = 0x4000;
     const uint16_t oamDMAAddr = 0x4014;
@@ -1693,6 +2298,7 @@ void CPU::write(const uint16_t addr, const uint8_t val) {
     if (addr < ppuCtrl) {
         ram.write(addr, val);
     } else if (addr < sq1Vol || addr == oamDMAAddr) {
+        syncPPU();
         ppu.writeRegister(addr, val, mmc, mute);
         if (addr == oamDMAAddr) {
             // Start the OAM DMA transfer
@@ -1708,13 +2314,36 @@ void CPU::write(const uint16_t addr, const uint8_t val) {
         }
         io.writeRegister(addr, val);
     } else if (addr >= prgRAMStart)  {
-        mmc.writePRG(addr, val, totalCycles);
+        const uint16_t prgROMStart = 0x8000;
+        // Writes to PRG-ROM can switch the PPU's pattern tables or mirroring
+        if (addr >= prgROMStart) {
+            syncPPU();
+        }
+        // Only rebuild the page table when the PRG banks that are swapped in change
+        if (mmc.writePRG(addr, val, totalCycles)) {
+            updatePages();
+        }
     }
+}
 
-    if (!mute) {
-        std::cout << std::hex << "0x" << (unsigned int) val << " has been written to the address 0x"
-            << (unsigned int) addr << "\n--------------------------------------------------\n" <<
-            std::dec;
+// Points each page in the page table to where it's stored. RAM and PRG-RAM can be read from and
+// written to directly. PRG-ROM can only be read from directly since writes to it control the MMC
+
+void CPU::updatePages() {
+    const unsigned int pageCount = 0x100;
+    const uint8_t ppuCtrlPage = 0x20;
+    const uint8_t prgROMPage = 0x80;
+    for (unsigned int i = 0; i < pageCount; ++i) {
+        if (i < ppuCtrlPage) {
+            readPages[i] = ram.getPage(i);
+            writePages[i] = ram.getPage(i);
+        } else if (i < prgROMPage) {
+            readPages[i] = mmc.getPRGPage(i);
+            writePages[i] = mmc.getPRGRAMPage(i);
+        } else {
+            readPages[i] = mmc.getPRGPage(i);
+            writePages[i] = nullptr;
+        }
     }
 }
 
@@ -1738,6 +2367,7 @@ void CPU::oamDMATransfer() {
         const unsigned int oamAddr = op.dmaCycle / 2 - 1;
         const uint16_t cpuAddr = cpuBaseAddr + oamAddr;
         const uint8_t cpuData = read(cpuAddr);
+        syncPPU();
         ppu.writeOAM(oamAddr, cpuData);
     }
 
@@ -1754,6 +2384,10 @@ void CPU::oamDMATransfer() {
 // https://www.nesdev.org/wiki/CPU_interrupts#Branch_instructions_and_interrupts
 
 void CPU::pollInterrupts() {
+    // Only catch the PPU up if it could have an NMI ready by now
+    if (pendingPPUCycles > 0 && ppu.isNMIPossible(pendingPPUCycles)) {
+        syncPPU();
+    }
     if (ppu.isNMIActive(mmc, mute)) {
         op.nmi = true;
     }
@@ -1967,4 +2601,284 @@ void CPU::setNegativeFlag(const bool val) {
     } else {
         p &= ~Negative;
     }
-}
\ No newline at end of file
+}
+
+// Instruction Descriptors
+// Generated from each opcode's addressing mode and operation. The cycle counts are the 6502's,
+// which the operation functions match except for the unofficial opcodes that aren't supported:
+// https://www.nesdev.org/wiki/CPU_unofficial_opcodes
+
+constexpr CPU::InstDescriptor CPU::instDescriptors[256] = {
+    // 0x00 - 0x0f
+    {&CPU::execute<&CPU::imp, &CPU::brk>, &CPU::brk, CPUOp::Implied, 0, 7, 0},
+    {&CPU::execute<&CPU::idx, &CPU::ora>, &CPU::ora, CPUOp::IndirectX, CPUOp::ReadInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::slo>, &CPU::slo, CPUOp::IndirectX, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::nop>, &CPU::nop, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::ora>, &CPU::ora, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::asl>, &CPU::asl, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::slo>, &CPU::slo, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::imp, &CPU::php>, &CPU::php, CPUOp::Implied, 0, 3, 0},
+    {&CPU::execute<&CPU::imm, &CPU::ora>, &CPU::ora, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::acc, &CPU::asl>, &CPU::asl, CPUOp::Accumulator, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::anc>, &CPU::anc, CPUOp::Immediate, 0, 2, 0},
+    {&CPU::execute<&CPU::abs, &CPU::nop>, &CPU::nop, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::ora>, &CPU::ora, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::asl>, &CPU::asl, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::abs, &CPU::slo>, &CPU::slo, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    // 0x10 - 0x1f
+    {&CPU::execute<&CPU::rel, &CPU::bpl>, &CPU::bpl, CPUOp::Relative, 0, 2, 1},
+    {&CPU::execute<&CPU::idy, &CPU::ora>, &CPU::ora, CPUOp::IndirectY, CPUOp::ReadInst, 5, 1},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idy, &CPU::slo>, &CPU::slo, CPUOp::IndirectY, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::nop>, &CPU::nop, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::ora>, &CPU::ora, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::asl>, &CPU::asl, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::slo>, &CPU::slo, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::clc>, &CPU::clc, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::ora>, &CPU::ora, CPUOp::AbsoluteY, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::imp, &CPU::nop>, &CPU::nop, CPUOp::Implied, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::slo>, &CPU::slo, CPUOp::AbsoluteY, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::nop>, &CPU::nop, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::ora>, &CPU::ora, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::asl>, &CPU::asl, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::slo>, &CPU::slo, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    // 0x20 - 0x2f
+    {&CPU::execute<&CPU::abs, &CPU::jsr>, &CPU::jsr, CPUOp::Absolute, 0, 6, 0},
+    {&CPU::execute<&CPU::idx, &CPU::andOp>, &CPU::andOp, CPUOp::IndirectX, CPUOp::ReadInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::rla>, &CPU::rla, CPUOp::IndirectX, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::bit>, &CPU::bit, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::andOp>, &CPU::andOp, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::rol>, &CPU::rol, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::rla>, &CPU::rla, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::imp, &CPU::plp>, &CPU::plp, CPUOp::Implied, 0, 4, 0},
+    {&CPU::execute<&CPU::imm, &CPU::andOp>, &CPU::andOp, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::acc, &CPU::rol>, &CPU::rol, CPUOp::Accumulator, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::anc>, &CPU::anc, CPUOp::Immediate, 0, 2, 0},
+    {&CPU::execute<&CPU::abs, &CPU::bit>, &CPU::bit, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::andOp>, &CPU::andOp, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::rol>, &CPU::rol, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::abs, &CPU::rla>, &CPU::rla, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    // 0x30 - 0x3f
+    {&CPU::execute<&CPU::rel, &CPU::bmi>, &CPU::bmi, CPUOp::Relative, 0, 2, 1},
+    {&CPU::execute<&CPU::idy, &CPU::andOp>, &CPU::andOp, CPUOp::IndirectY, CPUOp::ReadInst, 5, 1},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idy, &CPU::rla>, &CPU::rla, CPUOp::IndirectY, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::nop>, &CPU::nop, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::andOp>, &CPU::andOp, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::rol>, &CPU::rol, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::rla>, &CPU::rla, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::sec>, &CPU::sec, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::andOp>, &CPU::andOp, CPUOp::AbsoluteY, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::imp, &CPU::nop>, &CPU::nop, CPUOp::Implied, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::rla>, &CPU::rla, CPUOp::AbsoluteY, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::nop>, &CPU::nop, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::andOp>, &CPU::andOp, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::rol>, &CPU::rol, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::rla>, &CPU::rla, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    // 0x40 - 0x4f
+    {&CPU::execute<&CPU::imp, &CPU::rti>, &CPU::rti, CPUOp::Implied, 0, 6, 0},
+    {&CPU::execute<&CPU::idx, &CPU::eor>, &CPU::eor, CPUOp::IndirectX, CPUOp::ReadInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::sre>, &CPU::sre, CPUOp::IndirectX, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::nop>, &CPU::nop, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::eor>, &CPU::eor, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::lsr>, &CPU::lsr, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::sre>, &CPU::sre, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::imp, &CPU::pha>, &CPU::pha, CPUOp::Implied, 0, 3, 0},
+    {&CPU::execute<&CPU::imm, &CPU::eor>, &CPU::eor, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::acc, &CPU::lsr>, &CPU::lsr, CPUOp::Accumulator, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::alr>, &CPU::alr, CPUOp::Immediate, 0, 2, 0},
+    {&CPU::execute<&CPU::abs, &CPU::jmp>, &CPU::jmp, CPUOp::Absolute, 0, 3, 0},
+    {&CPU::execute<&CPU::abs, &CPU::eor>, &CPU::eor, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::lsr>, &CPU::lsr, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::abs, &CPU::sre>, &CPU::sre, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    // 0x50 - 0x5f
+    {&CPU::execute<&CPU::rel, &CPU::bvc>, &CPU::bvc, CPUOp::Relative, 0, 2, 1},
+    {&CPU::execute<&CPU::idy, &CPU::eor>, &CPU::eor, CPUOp::IndirectY, CPUOp::ReadInst, 5, 1},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idy, &CPU::sre>, &CPU::sre, CPUOp::IndirectY, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::nop>, &CPU::nop, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::eor>, &CPU::eor, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::lsr>, &CPU::lsr, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::sre>, &CPU::sre, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::cli>, &CPU::cli, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::eor>, &CPU::eor, CPUOp::AbsoluteY, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::imp, &CPU::nop>, &CPU::nop, CPUOp::Implied, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::sre>, &CPU::sre, CPUOp::AbsoluteY, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::nop>, &CPU::nop, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::eor>, &CPU::eor, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::lsr>, &CPU::lsr, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::sre>, &CPU::sre, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    // 0x60 - 0x6f
+    {&CPU::execute<&CPU::imp, &CPU::rts>, &CPU::rts, CPUOp::Implied, 0, 6, 0},
+    {&CPU::execute<&CPU::idx, &CPU::adc>, &CPU::adc, CPUOp::IndirectX, CPUOp::ReadInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::rra>, &CPU::rra, CPUOp::IndirectX, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::nop>, &CPU::nop, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::adc>, &CPU::adc, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::ror>, &CPU::ror, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::rra>, &CPU::rra, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::imp, &CPU::pla>, &CPU::pla, CPUOp::Implied, 0, 4, 0},
+    {&CPU::execute<&CPU::imm, &CPU::adc>, &CPU::adc, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::acc, &CPU::ror>, &CPU::ror, CPUOp::Accumulator, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::arr>, &CPU::arr, CPUOp::Immediate, 0, 2, 0},
+    {&CPU::execute<&CPU::idr, &CPU::jmp>, &CPU::jmp, CPUOp::Indirect, 0, 5, 0},
+    {&CPU::execute<&CPU::abs, &CPU::adc>, &CPU::adc, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::ror>, &CPU::ror, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::abs, &CPU::rra>, &CPU::rra, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    // 0x70 - 0x7f
+    {&CPU::execute<&CPU::rel, &CPU::bvs>, &CPU::bvs, CPUOp::Relative, 0, 2, 1},
+    {&CPU::execute<&CPU::idy, &CPU::adc>, &CPU::adc, CPUOp::IndirectY, CPUOp::ReadInst, 5, 1},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idy, &CPU::rra>, &CPU::rra, CPUOp::IndirectY, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::nop>, &CPU::nop, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::adc>, &CPU::adc, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::ror>, &CPU::ror, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::rra>, &CPU::rra, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::sei>, &CPU::sei, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::adc>, &CPU::adc, CPUOp::AbsoluteY, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::imp, &CPU::nop>, &CPU::nop, CPUOp::Implied, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::rra>, &CPU::rra, CPUOp::AbsoluteY, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::nop>, &CPU::nop, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::adc>, &CPU::adc, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::ror>, &CPU::ror, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::rra>, &CPU::rra, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    // 0x80 - 0x8f
+    {&CPU::execute<&CPU::imm, &CPU::nop>, &CPU::nop, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::sta>, &CPU::sta, CPUOp::IndirectX, CPUOp::WriteInst, 6, 0},
+    {&CPU::execute<&CPU::imm, &CPU::nop>, &CPU::nop, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::sax>, &CPU::sax, CPUOp::IndirectX, CPUOp::WriteInst, 6, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::sty>, &CPU::sty, CPUOp::ZeroPage, CPUOp::WriteInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::sta>, &CPU::sta, CPUOp::ZeroPage, CPUOp::WriteInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::stx>, &CPU::stx, CPUOp::ZeroPage, CPUOp::WriteInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::sax>, &CPU::sax, CPUOp::ZeroPage, CPUOp::WriteInst, 3, 0},
+    {&CPU::execute<&CPU::imp, &CPU::dey>, &CPU::dey, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::nop>, &CPU::nop, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::imp, &CPU::txa>, &CPU::txa, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::xaa>, &CPU::xaa, CPUOp::Immediate, 0, 2, 0},
+    {&CPU::execute<&CPU::abs, &CPU::sty>, &CPU::sty, CPUOp::Absolute, CPUOp::WriteInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::sta>, &CPU::sta, CPUOp::Absolute, CPUOp::WriteInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::stx>, &CPU::stx, CPUOp::Absolute, CPUOp::WriteInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::sax>, &CPU::sax, CPUOp::Absolute, CPUOp::WriteInst, 4, 0},
+    // 0x90 - 0x9f
+    {&CPU::execute<&CPU::rel, &CPU::bcc>, &CPU::bcc, CPUOp::Relative, 0, 2, 1},
+    {&CPU::execute<&CPU::idy, &CPU::sta>, &CPU::sta, CPUOp::IndirectY, CPUOp::WriteInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idy, &CPU::ahx>, &CPU::ahx, CPUOp::IndirectY, 0, 6, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::sty>, &CPU::sty, CPUOp::ZeroPageX, CPUOp::WriteInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::sta>, &CPU::sta, CPUOp::ZeroPageX, CPUOp::WriteInst, 4, 0},
+    {&CPU::execute<&CPU::zpy, &CPU::stx>, &CPU::stx, CPUOp::ZeroPageY, CPUOp::WriteInst, 4, 0},
+    {&CPU::execute<&CPU::zpy, &CPU::sax>, &CPU::sax, CPUOp::ZeroPageY, CPUOp::WriteInst, 4, 0},
+    {&CPU::execute<&CPU::imp, &CPU::tya>, &CPU::tya, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::sta>, &CPU::sta, CPUOp::AbsoluteY, CPUOp::WriteInst, 5, 0},
+    {&CPU::execute<&CPU::imp, &CPU::txs>, &CPU::txs, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::tas>, &CPU::tas, CPUOp::AbsoluteY, 0, 5, 0},
+    {&CPU::execute<&CPU::abx, &CPU::shy>, &CPU::shy, CPUOp::AbsoluteX, 0, 5, 0},
+    {&CPU::execute<&CPU::abx, &CPU::sta>, &CPU::sta, CPUOp::AbsoluteX, CPUOp::WriteInst, 5, 0},
+    {&CPU::execute<&CPU::aby, &CPU::shx>, &CPU::shx, CPUOp::AbsoluteY, 0, 5, 0},
+    {&CPU::execute<&CPU::aby, &CPU::ahx>, &CPU::ahx, CPUOp::AbsoluteY, 0, 5, 0},
+    // 0xa0 - 0xaf
+    {&CPU::execute<&CPU::imm, &CPU::ldy>, &CPU::ldy, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::lda>, &CPU::lda, CPUOp::IndirectX, CPUOp::ReadInst, 6, 0},
+    {&CPU::execute<&CPU::imm, &CPU::ldx>, &CPU::ldx, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::lax>, &CPU::lax, CPUOp::IndirectX, CPUOp::ReadInst, 6, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::ldy>, &CPU::ldy, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::lda>, &CPU::lda, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::ldx>, &CPU::ldx, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::lax>, &CPU::lax, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::imp, &CPU::tay>, &CPU::tay, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::lda>, &CPU::lda, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::imp, &CPU::tax>, &CPU::tax, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::lax>, &CPU::lax, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::abs, &CPU::ldy>, &CPU::ldy, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::lda>, &CPU::lda, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::ldx>, &CPU::ldx, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::lax>, &CPU::lax, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    // 0xb0 - 0xbf
+    {&CPU::execute<&CPU::rel, &CPU::bcs>, &CPU::bcs, CPUOp::Relative, 0, 2, 1},
+    {&CPU::execute<&CPU::idy, &CPU::lda>, &CPU::lda, CPUOp::IndirectY, CPUOp::ReadInst, 5, 1},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idy, &CPU::lax>, &CPU::lax, CPUOp::IndirectY, CPUOp::ReadInst, 5, 1},
+    {&CPU::execute<&CPU::zpx, &CPU::ldy>, &CPU::ldy, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::lda>, &CPU::lda, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpy, &CPU::ldx>, &CPU::ldx, CPUOp::ZeroPageY, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpy, &CPU::lax>, &CPU::lax, CPUOp::ZeroPageY, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::imp, &CPU::clv>, &CPU::clv, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::lda>, &CPU::lda, CPUOp::AbsoluteY, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::imp, &CPU::tsx>, &CPU::tsx, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::las>, &CPU::las, CPUOp::AbsoluteY, 0, 4, 0},
+    {&CPU::execute<&CPU::abx, &CPU::ldy>, &CPU::ldy, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::lda>, &CPU::lda, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::aby, &CPU::ldx>, &CPU::ldx, CPUOp::AbsoluteY, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::aby, &CPU::lax>, &CPU::lax, CPUOp::AbsoluteY, CPUOp::ReadInst, 4, 1},
+    // 0xc0 - 0xcf
+    {&CPU::execute<&CPU::imm, &CPU::cpy>, &CPU::cpy, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::cmp>, &CPU::cmp, CPUOp::IndirectX, CPUOp::ReadInst, 6, 0},
+    {&CPU::execute<&CPU::imm, &CPU::nop>, &CPU::nop, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::dcp>, &CPU::dcp, CPUOp::IndirectX, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::cpy>, &CPU::cpy, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::cmp>, &CPU::cmp, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::dec>, &CPU::dec, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::dcp>, &CPU::dcp, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::imp, &CPU::iny>, &CPU::iny, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::cmp>, &CPU::cmp, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::imp, &CPU::dex>, &CPU::dex, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::axs>, &CPU::axs, CPUOp::Immediate, 0, 2, 0},
+    {&CPU::execute<&CPU::abs, &CPU::cpy>, &CPU::cpy, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::cmp>, &CPU::cmp, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::dec>, &CPU::dec, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::abs, &CPU::dcp>, &CPU::dcp, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    // 0xd0 - 0xdf
+    {&CPU::execute<&CPU::rel, &CPU::bne>, &CPU::bne, CPUOp::Relative, 0, 2, 1},
+    {&CPU::execute<&CPU::idy, &CPU::cmp>, &CPU::cmp, CPUOp::IndirectY, CPUOp::ReadInst, 5, 1},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idy, &CPU::dcp>, &CPU::dcp, CPUOp::IndirectY, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::nop>, &CPU::nop, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::cmp>, &CPU::cmp, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::dec>, &CPU::dec, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::dcp>, &CPU::dcp, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::cld>, &CPU::cld, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::cmp>, &CPU::cmp, CPUOp::AbsoluteY, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::imp, &CPU::nop>, &CPU::nop, CPUOp::Implied, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::dcp>, &CPU::dcp, CPUOp::AbsoluteY, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::nop>, &CPU::nop, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::cmp>, &CPU::cmp, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::dec>, &CPU::dec, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::dcp>, &CPU::dcp, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    // 0xe0 - 0xef
+    {&CPU::execute<&CPU::imm, &CPU::cpx>, &CPU::cpx, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::sbc>, &CPU::sbc, CPUOp::IndirectX, CPUOp::ReadInst, 6, 0},
+    {&CPU::execute<&CPU::imm, &CPU::nop>, &CPU::nop, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::idx, &CPU::isc>, &CPU::isc, CPUOp::IndirectX, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::cpx>, &CPU::cpx, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::sbc>, &CPU::sbc, CPUOp::ZeroPage, CPUOp::ReadInst, 3, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::inc>, &CPU::inc, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::zpg, &CPU::isc>, &CPU::isc, CPUOp::ZeroPage, CPUOp::RMWInst, 5, 0},
+    {&CPU::execute<&CPU::imp, &CPU::inx>, &CPU::inx, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::sbc>, &CPU::sbc, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::imp, &CPU::nop>, &CPU::nop, CPUOp::Implied, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::imm, &CPU::sbc>, &CPU::sbc, CPUOp::Immediate, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::abs, &CPU::cpx>, &CPU::cpx, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::sbc>, &CPU::sbc, CPUOp::Absolute, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::abs, &CPU::inc>, &CPU::inc, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::abs, &CPU::isc>, &CPU::isc, CPUOp::Absolute, CPUOp::RMWInst, 6, 0},
+    // 0xf0 - 0xff
+    {&CPU::execute<&CPU::rel, &CPU::beq>, &CPU::beq, CPUOp::Relative, 0, 2, 1},
+    {&CPU::execute<&CPU::idy, &CPU::sbc>, &CPU::sbc, CPUOp::IndirectY, CPUOp::ReadInst, 5, 1},
+    {&CPU::execute<&CPU::imp, &CPU::stp>, &CPU::stp, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::idy, &CPU::isc>, &CPU::isc, CPUOp::IndirectY, CPUOp::RMWInst, 8, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::nop>, &CPU::nop, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::sbc>, &CPU::sbc, CPUOp::ZeroPageX, CPUOp::ReadInst, 4, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::inc>, &CPU::inc, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::zpx, &CPU::isc>, &CPU::isc, CPUOp::ZeroPageX, CPUOp::RMWInst, 6, 0},
+    {&CPU::execute<&CPU::imp, &CPU::sed>, &CPU::sed, CPUOp::Implied, 0, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::sbc>, &CPU::sbc, CPUOp::AbsoluteY, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::imp, &CPU::nop>, &CPU::nop, CPUOp::Implied, CPUOp::ReadInst, 2, 0},
+    {&CPU::execute<&CPU::aby, &CPU::isc>, &CPU::isc, CPUOp::AbsoluteY, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::nop>, &CPU::nop, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::sbc>, &CPU::sbc, CPUOp::AbsoluteX, CPUOp::ReadInst, 4, 1},
+    {&CPU::execute<&CPU::abx, &CPU::inc>, &CPU::inc, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0},
+    {&CPU::execute<&CPU::abx, &CPU::isc>, &CPU::isc, CPUOp::AbsoluteX, CPUOp::RMWInst, 7, 0}
+};
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define CPU_H
 
 #include <bitset>
+#include <memory>
+#include <string>
 
 #include "apu.h"
 #include "cpu-op.h"
@@ -14,8 +16,28 @@
 class CPU {
     public:
         CPU();
+        CPU(const CPU& other);
+        CPU& operator=(const CPU& other);
         void clear();
-        void step(SDL_Renderer* renderer, SDL_Texture* texture);
+        void step();
+
+        // Reasons for runCycles and runFrame to return
+        enum RunResult {
+            // The given number of cycles have been executed
+            BudgetReached,
+            // The PPU finished rendering a frame
+            FrameDone,
+            // The PC reached the breakpoint
+            BreakpointHit,
+            // BRK was executed while haltAtBrk is set
+            ProgramEnded
+        };
+
+        // Batch Execution
+        RunResult runCycles(const unsigned int cycles);
+        RunResult runFrame();
+        void runInstruction();
+        void runPPUCycles(const unsigned int cycles);
 
         // Struct that represents the CPU's state. Used for comparisons
         struct State {
@@ -30,10 +52,15 @@ class CPU {
 
         // File Reading
         void readInInst(const std::string& filename);
-        void readInINES(const std::string& filename);
+        bool readInINES(const std::string& filename, std::string& error);
+        bool loadImage(const std::shared_ptr<const ROMImage>& image);
+
+        // Save States
+        void saveState(StateWriter& writer);
+        bool loadState(StateReader& reader);
 
         // Miscellaneous Functions
-        void updateButton(const SDL_Event& event);
+        void setButtons(const unsigned int port, const uint8_t mask);
         bool compareState(const struct CPU::State& state) const;
 
         // Getters
@@ -44,18 +71,29 @@ class CPU {
         bool isHaltAtBrk() const;
         unsigned int getOpCycles() const;
         uint8_t readRAM(const uint16_t addr) const;
+        const uint8_t* getRAM() const;
         unsigned int getTotalPPUCycles() const;
         uint8_t readPRG(const uint16_t addr) const;
+        const uint32_t* getFrameBuffer() const;
+        bool isFastInstructions() const;
 
         // Setters
         void setHaltAtBrk(const bool h);
         void setMute(const bool m);
+        void setCatchUpPPU(const bool c);
+        void setFastInstructions(const bool f);
+        void setPPURenderMode(const unsigned int mode);
+        void setFrameBuffer(uint32_t* pixels, const unsigned int pitch);
+        void setFrameOutput(const bool output);
+        bool setOption(const std::string& option);
+        void setBreakpoint(const uint16_t addr);
+        void clearBreakpoint();
         void clearTotalPPUCycles();
 
         // Printing
         void print(const bool isCycleDone) const;
         void printUnknownOp() const;
-        void printStateInst(const uint32_t inst) const;
+        void printStateInst(const uint32_t inst, std::ostream& out) const;
         void printPPU() const;
 
     private:
@@ -75,90 +113,61 @@ class CPU {
         bool endOfProgram; // Set to true if haltAtBrk is true and break operation is ran
         bool haltAtBrk; // Set to true if the program should halt when the break operation is ran
         bool mute; // Set to true to hide debug info
+        uint16_t breakpoint; // PC that runCycles and runFrame stop at
+        bool hasBreakpoint; // Set to true if runCycles and runFrame should stop at the breakpoint
+        // Set to true to run the PPU only when the CPU interacts with it instead of on every cycle
+        bool catchUpPPU;
+        unsigned int pendingPPUCycles; // Number of PPU cycles that the PPU is behind the CPU by
+        bool frameDoneDuringSync; // Set to true if the PPU rendered the frame while catching up
+        // Set to true to execute instructions that can't interact with the PPU or end a run early
+        // in one go instead of cycle by cycle. Only done while catching the PPU up
+        bool fastInstructions;
+        // Pointers to where each 256-byte page of the CPU memory map is stored, indexed by the high
+        // byte of the address. nullptr if accesses to the page have to be passed to the component
+        // that is responsible for it instead (e.g., PPU registers or mapper registers)
+        const uint8_t* readPages[0x100];
+        uint8_t* writePages[0x100];
 
-        // These arrays map machine language opcodes to addressing mode and operation function calls
-        // that are associated with said opcodes
         typedef void (CPU::*funcPtr)();
-        funcPtr addrModeArr[256] = {
-            &CPU::imp, &CPU::idx, &CPU::imp, &CPU::idx, &CPU::zpg, &CPU::zpg, &CPU::zpg, &CPU::zpg,
-            &CPU::imp, &CPU::imm, &CPU::acc, &CPU::imm, &CPU::abs, &CPU::abs, &CPU::abs, &CPU::abs,
-            &CPU::rel, &CPU::idy, &CPU::imp, &CPU::idy, &CPU::zpx, &CPU::zpx, &CPU::zpx, &CPU::zpx,
-            &CPU::imp, &CPU::aby, &CPU::imp, &CPU::aby, &CPU::abx, &CPU::abx, &CPU::abx, &CPU::abx,
-            &CPU::abs, &CPU::idx, &CPU::imp, &CPU::idx, &CPU::zpg, &CPU::zpg, &CPU::zpg, &CPU::zpg,
-            &CPU::imp, &CPU::imm, &CPU::acc, &CPU::imm, &CPU::abs, &CPU::abs, &CPU::abs, &CPU::abs,
-            &CPU::rel, &CPU::idy, &CPU::imp, &CPU::idy, &CPU::zpx, &CPU::zpx, &CPU::zpx, &CPU::zpx,
-            &CPU::imp, &CPU::aby, &CPU::imp, &CPU::aby, &CPU::abx, &CPU::abx, &CPU::abx, &CPU::abx,
-            &CPU::imp, &CPU::idx, &CPU::imp, &CPU::idx, &CPU::zpg, &CPU::zpg, &CPU::zpg, &CPU::zpg,
-            &CPU::imp, &CPU::imm, &CPU::acc, &CPU::imm, &CPU::abs, &CPU::abs, &CPU::abs, &CPU::abs,
-            &CPU::rel, &CPU::idy, &CPU::imp, &CPU::idy, &CPU::zpx, &CPU::zpx, &CPU::zpx, &CPU::zpx,
-            &CPU::imp, &CPU::aby, &CPU::imp, &CPU::aby, &CPU::abx, &CPU::abx, &CPU::abx, &CPU::abx,
-            &CPU::imp, &CPU::idx, &CPU::imp, &CPU::idx, &CPU::zpg, &CPU::zpg, &CPU::zpg, &CPU::zpg,
-            &CPU::imp, &CPU::imm, &CPU::acc, &CPU::imm, &CPU::idr, &CPU::abs, &CPU::abs, &CPU::abs,
-            &CPU::rel, &CPU::idy, &CPU::imp, &CPU::idy, &CPU::zpx, &CPU::zpx, &CPU::zpx, &CPU::zpx,
-            &CPU::imp, &CPU::aby, &CPU::imp, &CPU::aby, &CPU::abx, &CPU::abx, &CPU::abx, &CPU::abx,
-            &CPU::imm, &CPU::idx, &CPU::imm, &CPU::idx, &CPU::zpg, &CPU::zpg, &CPU::zpg, &CPU::zpg,
-            &CPU::imp, &CPU::imm, &CPU::imp, &CPU::imm, &CPU::abs, &CPU::abs, &CPU::abs, &CPU::abs,
-            &CPU::rel, &CPU::idy, &CPU::imp, &CPU::idy, &CPU::zpx, &CPU::zpx, &CPU::zpy, &CPU::zpy,
-            &CPU::imp, &CPU::aby, &CPU::imp, &CPU::aby, &CPU::abx, &CPU::abx, &CPU::aby, &CPU::aby,
-            &CPU::imm, &CPU::idx, &CPU::imm, &CPU::idx, &CPU::zpg, &CPU::zpg, &CPU::zpg, &CPU::zpg,
-            &CPU::imp, &CPU::imm, &CPU::imp, &CPU::imm, &CPU::abs, &CPU::abs, &CPU::abs, &CPU::abs,
-            &CPU::rel, &CPU::idy, &CPU::imp, &CPU::idy, &CPU::zpx, &CPU::zpx, &CPU::zpy, &CPU::zpy,
-            &CPU::imp, &CPU::aby, &CPU::imp, &CPU::aby, &CPU::abx, &CPU::abx, &CPU::aby, &CPU::aby,
-            &CPU::imm, &CPU::idx, &CPU::imm, &CPU::idx, &CPU::zpg, &CPU::zpg, &CPU::zpg, &CPU::zpg,
-            &CPU::imp, &CPU::imm, &CPU::imp, &CPU::imm, &CPU::abs, &CPU::abs, &CPU::abs, &CPU::abs,
-            &CPU::rel, &CPU::idy, &CPU::imp, &CPU::idy, &CPU::zpx, &CPU::zpx, &CPU::zpx, &CPU::zpx,
-            &CPU::imp, &CPU::aby, &CPU::imp, &CPU::aby, &CPU::abx, &CPU::abx, &CPU::abx, &CPU::abx,
-            &CPU::imm, &CPU::idx, &CPU::imm, &CPU::idx, &CPU::zpg, &CPU::zpg, &CPU::zpg, &CPU::zpg,
-            &CPU::imp, &CPU::imm, &CPU::imp, &CPU::imm, &CPU::abs, &CPU::abs, &CPU::abs, &CPU::abs,
-            &CPU::rel, &CPU::idy, &CPU::imp, &CPU::idy, &CPU::zpx, &CPU::zpx, &CPU::zpx, &CPU::zpx,
-            &CPU::imp, &CPU::aby, &CPU::imp, &CPU::aby, &CPU::abx, &CPU::abx, &CPU::abx, &CPU::abx
-        };
-        funcPtr opcodeArr[256] = {
-            &CPU::brk,   &CPU::ora,   &CPU::stp,   &CPU::slo,   &CPU::nop,   &CPU::ora,
-            &CPU::asl,   &CPU::slo,   &CPU::php,   &CPU::ora,   &CPU::asl,   &CPU::anc,
-            &CPU::nop,   &CPU::ora,   &CPU::asl,   &CPU::slo,   &CPU::bpl,   &CPU::ora,
-            &CPU::stp,   &CPU::slo,   &CPU::nop,   &CPU::ora,   &CPU::asl,   &CPU::slo,
-            &CPU::clc,   &CPU::ora,   &CPU::nop,   &CPU::slo,   &CPU::nop,   &CPU::ora,
-            &CPU::asl,   &CPU::slo,   &CPU::jsr,   &CPU::andOp, &CPU::stp,   &CPU::rla,
-            &CPU::bit,   &CPU::andOp, &CPU::rol,   &CPU::rla,   &CPU::plp,   &CPU::andOp,
-            &CPU::rol,   &CPU::anc,   &CPU::bit,   &CPU::andOp, &CPU::rol,   &CPU::rla,
-            &CPU::bmi,   &CPU::andOp, &CPU::stp,   &CPU::rla,   &CPU::nop,   &CPU::andOp,
-            &CPU::rol,   &CPU::rla,   &CPU::sec,   &CPU::andOp, &CPU::nop,   &CPU::rla,
-            &CPU::nop,   &CPU::andOp, &CPU::rol,   &CPU::rla,   &CPU::rti,   &CPU::eor,
-            &CPU::stp,   &CPU::sre,   &CPU::nop,   &CPU::eor,   &CPU::lsr,   &CPU::sre,
-            &CPU::pha,   &CPU::eor,   &CPU::lsr,   &CPU::alr,   &CPU::jmp,   &CPU::eor,
-            &CPU::lsr,   &CPU::sre,   &CPU::bvc,   &CPU::eor,   &CPU::stp,   &CPU::sre,
-            &CPU::nop,   &CPU::eor,   &CPU::lsr,   &CPU::sre,   &CPU::cli,   &CPU::eor,
-            &CPU::nop,   &CPU::sre,   &CPU::nop,   &CPU::eor,   &CPU::lsr,   &CPU::sre,
-            &CPU::rts,   &CPU::adc,   &CPU::stp,   &CPU::rra,   &CPU::nop,   &CPU::adc,
-            &CPU::ror,   &CPU::rra,   &CPU::pla,   &CPU::adc,   &CPU::ror,   &CPU::arr,
-            &CPU::jmp,   &CPU::adc,   &CPU::ror,   &CPU::rra,   &CPU::bvs,   &CPU::adc,
-            &CPU::stp,   &CPU::rra,   &CPU::nop,   &CPU::adc,   &CPU::ror,   &CPU::rra,
-            &CPU::sei,   &CPU::adc,   &CPU::nop,   &CPU::rra,   &CPU::nop,   &CPU::adc,
-            &CPU::ror,   &CPU::rra,   &CPU::nop,   &CPU::sta,   &CPU::nop,   &CPU::sax,
-            &CPU::sty,   &CPU::sta,   &CPU::stx,   &CPU::sax,   &CPU::dey,   &CPU::nop,
-            &CPU::txa,   &CPU::xaa,   &CPU::sty,   &CPU::sta,   &CPU::stx,   &CPU::sax,
-            &CPU::bcc,   &CPU::sta,   &CPU::stp,   &CPU::ahx,   &CPU::sty,   &CPU::sta,
-            &CPU::stx,   &CPU::sax,   &CPU::tya,   &CPU::sta,   &CPU::txs,   &CPU::tas,
-            &CPU::shy,   &CPU::sta,   &CPU::shx,   &CPU::ahx,   &CPU::ldy,   &CPU::lda,
-            &CPU::ldx,   &CPU::lax,   &CPU::ldy,   &CPU::lda,   &CPU::ldx,   &CPU::lax,
-            &CPU::tay,   &CPU::lda,   &CPU::tax,   &CPU::lax,   &CPU::ldy,   &CPU::lda,
-            &CPU::ldx,   &CPU::lax,   &CPU::bcs,   &CPU::lda,   &CPU::stp,   &CPU::lax,
-            &CPU::ldy,   &CPU::lda,   &CPU::ldx,   &CPU::lax,   &CPU::clv,   &CPU::lda,
-            &CPU::tsx,   &CPU::las,   &CPU::ldy,   &CPU::lda,   &CPU::ldx,   &CPU::lax,
-            &CPU::cpy,   &CPU::cmp,   &CPU::nop,   &CPU::dcp,   &CPU::cpy,   &CPU::cmp,
-            &CPU::dec,   &CPU::dcp,   &CPU::iny,   &CPU::cmp,   &CPU::dex,   &CPU::axs,
-            &CPU::cpy,   &CPU::cmp,   &CPU::dec,   &CPU::dcp,   &CPU::bne,   &CPU::cmp,
-            &CPU::stp,   &CPU::dcp,   &CPU::nop,   &CPU::cmp,   &CPU::dec,   &CPU::dcp,
-            &CPU::cld,   &CPU::cmp,   &CPU::nop,   &CPU::dcp,   &CPU::nop,   &CPU::cmp,
-            &CPU::dec,   &CPU::dcp,   &CPU::cpx,   &CPU::sbc,   &CPU::nop,   &CPU::isc,
-            &CPU::cpx,   &CPU::sbc,   &CPU::inc,   &CPU::isc,   &CPU::inx,   &CPU::sbc,
-            &CPU::nop,   &CPU::sbc,   &CPU::cpx,   &CPU::sbc,   &CPU::inc,   &CPU::isc,
-            &CPU::beq,   &CPU::sbc,   &CPU::stp,   &CPU::isc,   &CPU::nop,   &CPU::sbc,
-            &CPU::inc,   &CPU::isc,   &CPU::sed,   &CPU::sbc,   &CPU::nop,   &CPU::isc,
-            &CPU::nop,   &CPU::sbc,   &CPU::inc,   &CPU::isc
+
+        // Static info about an opcode. The addressing mode and operation functions of the opcode
+        // are fused into one function so that each cycle only needs one indirect call
+        struct InstDescriptor {
+            // Runs the addressing mode function and then the operation function for one cycle
+            funcPtr execute;
+            // Runs only the operation function. Used when executing the whole instruction at once
+            funcPtr operation;
+            // Depends on enum CPUOp::AddrMode
+            uint8_t addrMode;
+            // Depends on enum CPUOp::InstType. 0 if the instruction isn't a read, write, or
+            // read-modify-write instruction
+            uint8_t instType;
+            // Number of cycles if no page boundary is crossed and no branch is taken
+            uint8_t cycles;
+            // Number of extra cycles if the page boundary is crossed
+            uint8_t pageCrossPenalty;
         };
 
+        // Maps machine language opcodes to their descriptors
+        static const InstDescriptor instDescriptors[256];
+
+        // Cycle Execution
+        bool runCycle();
+        template <funcPtr addrModeFunc, funcPtr opFunc>
+        void execute();
+        template <bool stopAtFrameEnd>
+        RunResult run(unsigned int cycles);
+
+        // PPU Catch-Up
+        void syncPPU();
+        unsigned int getCyclesUntilFrameCheck() const;
+
+        // Fast Instructions
+        unsigned int runFastInstruction(const unsigned int maxCycles);
+        static unsigned int getInstLength(const unsigned int addrMode);
+        bool isFastReadable(const uint16_t addr) const;
+        bool isFastWritable(const uint16_t addr) const;
+
         // Addressing Modes
         void abs(); // ABSolute
         void abx(); // ABsolute, X
@@ -255,6 +264,9 @@ class CPU {
         // Read/Write Functions
         uint8_t read(const uint16_t addr);
         void write(const uint16_t addr, const uint8_t val);
+        uint8_t readComponent(const uint16_t addr);
+        void writeComponent(const uint16_t addr, const uint8_t val);
+        void updatePages();
         void oamDMATransfer();
 
         // Interrupts
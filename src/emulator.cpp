@@ -1,6 +1,99 @@
 #include <chrono>
+#include <filesystem>
+#include <sstream>
 
+#include "allocation-counter.h"
+#include "batch-runner.h"
 #include "cpu.h"
+#include "frame-presenter.h"
+#include "frame-scheduler.h"
+#include "hash.h"
+#include "nes-core.h"
+#include "option-parser.h"
+#include "rewind-buffer.h"
+
+// Stop conditions and options for running an .NES file without graphics. The run ends when any of
+// the given conditions is met
+struct HeadlessOptions {
+    // Max number of frames to run. 0 means that there is no frame limit
+    unsigned int frames = 0;
+    // Set to true if the run should stop once the CPU reaches stopPC
+    bool stopAtPC = false;
+    uint16_t stopPC = 0;
+    // Set to true if the run should stop once the value at stopAddr equals stopVal. Checked at the
+    // end of every frame
+    bool stopAtVal = false;
+    uint16_t stopAddr = 0;
+    uint8_t stopVal = 0;
+    // Only every Nth frame is output, as if the run were fast-forwarded N times. The frames in
+    // between skip looking up the color of each pixel
+    unsigned int fastForward = 1;
+};
+
+// Ways that a test ROM shows whether it passed
+enum ROMTestKind {
+    // Every instruction is compared with nestest.log
+    NESTestLog,
+    // Passes if the CPU reaches stopPC before failedPC
+    PCTest,
+    // Runs until the CPU reaches stopPC, then passes if testResultAddr holds passedTestResult
+    ResultTest
+};
+
+// A test ROM in the test directory. Depends on enum ROMTestKind
+struct ROMTest {
+    unsigned int kind;
+    std::string directory;
+    std::string name;
+    uint16_t stopPC;
+    uint16_t failedPC;
+    uint8_t passedTestResult;
+    uint16_t testResultAddr;
+};
+
+// A made-up .NES file for testing how headers are parsed. The file is the 16 bytes of the header
+// followed by zeros up to fileBytes, except for a marker byte where the PRG-ROM should start
+struct HeaderTest {
+    std::string name;
+    std::vector<uint8_t> header;
+    size_t fileBytes;
+    // Set to false if the file should be rejected
+    bool valid;
+    // Where the PRG-ROM starts in the file
+    size_t prgROMOffset;
+    struct ROMImage::Header expected;
+};
+
+// Outcome of a test that was run by runParallelTests
+struct TestResult {
+    std::string name;
+    bool passed = false;
+    // What the test printed, which says why it failed if it did
+    std::string output;
+    unsigned int cycles = 0;
+    double seconds = 0;
+};
+
+// How long runFrame takes for each frame that's displayed. Reported when run-ahead is on, since
+// every displayed frame then costs more than one frame of emulation
+struct FrameTimes {
+    unsigned int frames = 0;
+    double totalMicroseconds = 0;
+    double maxMicroseconds = 0;
+};
+
+// What the keyboard is doing in the game. The main thread polls the events and sets these, and the
+// emulation thread reads them once per frame
+struct GameControls {
+    // Buttons that are held on joystick 1. Depends on enum IO::Button
+    std::atomic<uint8_t> buttons = 0;
+    // Set to true while the rewind key is held
+    std::atomic<bool> rewinding = false;
+    // Toggled by the fast-forward key
+    std::atomic<bool> fastForwarding = false;
+    // Cleared when the window is closed
+    std::atomic<bool> running = true;
+};
 
 void readInFilenames(std::vector<std::string>& filenames);
 
@@ -15,19 +108,94 @@ void stepAndPrint(CPU& cpu, const bool showPPU);
 
 void runInstTests(CPU& cpu, const std::vector<std::string>& filenames);
 
+bool runInstTest(CPU& cpu, const std::string& filename);
+
+void runHeaderTests();
+
+std::vector<struct HeaderTest> getHeaderTests();
+
+struct HeaderTest& addHeaderTest(std::vector<struct HeaderTest>& tests, const std::string& name,
+    const std::vector<uint8_t>& header, const size_t fileBytes);
+
+bool compareHeaders(const struct ROMImage::Header& header,
+    const struct ROMImage::Header& expected);
+
 void runNESTests(CPU& cpu);
 
 void runCPUTests(CPU& cpu);
 
 void runPPUTests(CPU& cpu);
 
-void runIndividualTest(CPU& cpu, const std::string& testName, const std::string& testDirectory,
-    const uint16_t stopPC, const uint8_t passedTestResult, const uint16_t testResultAddr);
+std::vector<struct ROMTest> getCPUTests();
+
+std::vector<struct ROMTest> getPPUTests();
+
+bool runROMTest(CPU& cpu, const struct ROMTest& test, std::ostream& out);
+
+bool runNESTestLog(CPU& cpu, std::ostream& out);
+
+void runParallelTests(int argc, char* argv[], const std::vector<std::string>& cpuOptions);
+
+void writeJSONString(std::ostream& out, const std::string& str);
+
+void runNESGame(NESCore& core, const std::string& filename);
+
+void runEmulation(NESCore& core, FramePresenter& presenter, const struct GameControls& controls,
+    struct FrameTimes& frameTimes);
+
+std::vector<uint8_t> readInFile(const std::string& filename);
+
+std::shared_ptr<const ROMImage> readInROM(const std::string& filename);
+
+void readInINES(CPU& cpu, const std::string& filename);
+
+uint8_t getButton(const SDL_Keycode key);
+
+struct HeadlessOptions readInHeadlessOptions(int argc, char* argv[]);
+
+void runHeadless(NESCore& core, const std::string& filename,
+    const struct HeadlessOptions& options);
+
+void runPPUBenchmark(CPU& cpu, const std::string& filename, int argc, char* argv[]);
 
-void runNESGame(CPU& cpu, const std::string& filename);
+void runBatchBenchmark(const std::string& filename, int argc, char* argv[],
+    const std::vector<std::string>& cpuOptions);
+
+void runLoadBenchmark(const std::string& path, int argc, char* argv[]);
+
+void runStateBenchmark(NESCore& core, const std::string& filename, int argc, char* argv[]);
+
+void runRewindBenchmark(NESCore& core, const std::string& filename, int argc, char* argv[]);
+
+uint8_t readMemory(const CPU& cpu, const uint16_t addr);
+
+bool readInCoreOption(NESCore& core, const std::string& arg);
+
+void addFrameTime(struct FrameTimes& times, const std::chrono::steady_clock::duration time);
+
+void printRunAheadStats(const NESCore& core, const struct FrameTimes& times);
 
 int main(int argc, char* argv[]) {
+    NESCore core;
+    // The tests, the debugger, and the PPU benchmark run a CPU of their own since they need more
+    // than NESCore gives access to
     CPU cpu;
+    // Options that configure the CPU can be given with any of the run modes, so they're applied and
+    // removed before the rest of the arguments are looked at. They're kept for run modes that have
+    // more than one CPU
+    std::vector<char*> args(argv, argv + 1);
+    std::vector<std::string> cpuOptions;
+    for (int i = 1; i < argc; ++i) {
+        if (core.setOption(argv[i])) {
+            cpu.setOption(argv[i]);
+            cpuOptions.push_back(argv[i]);
+        } else if (!readInCoreOption(core, argv[i])) {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = args.size();
+    argv = args.data();
+
     if (argc == 1) {
         // The end of the instruction tests are when the program reaches zeroed out memory, and the
         // BRK instruction is 0
@@ -35,9 +203,12 @@ int main(int argc, char* argv[]) {
         std::vector<std::string> filenames;
         readInFilenames(filenames);
         runInstTests(cpu, filenames);
+        runHeaderTests();
         cpu.setHaltAtBrk(false);
         cpu.clear();
         runNESTests(cpu);
+    } else if (std::string(argv[1]) == "tests") {
+        runParallelTests(argc, argv, cpuOptions);
     } else if (argc == 2) {
         const std::string filename(argv[1]);
         if (filename.size() < 5) {
@@ -49,7 +220,26 @@ int main(int argc, char* argv[]) {
             std::cerr << "Wrong filename extension\n";
             exit(1);
         }
-        runNESGame(cpu, filename);
+        runNESGame(core, filename);
+    } else if (argc >= 3 && std::string(argv[2]) == "headless") {
+        const std::string filename(argv[1]);
+        const struct HeadlessOptions options = readInHeadlessOptions(argc, argv);
+        runHeadless(core, filename, options);
+    } else if (argc >= 3 && std::string(argv[2]) == "ppubench") {
+        const std::string filename(argv[1]);
+        runPPUBenchmark(cpu, filename, argc, argv);
+    } else if (argc >= 3 && std::string(argv[2]) == "batch") {
+        const std::string filename(argv[1]);
+        runBatchBenchmark(filename, argc, argv, cpuOptions);
+    } else if (argc >= 3 && std::string(argv[2]) == "loadbench") {
+        const std::string path(argv[1]);
+        runLoadBenchmark(path, argc, argv);
+    } else if (argc >= 3 && std::string(argv[2]) == "statebench") {
+        const std::string filename(argv[1]);
+        runStateBenchmark(core, filename, argc, argv);
+    } else if (argc >= 3 && std::string(argv[2]) == "rewindbench") {
+        const std::string filename(argv[1]);
+        runRewindBenchmark(core, filename, argc, argv);
     } else if (argc == 3) {
         const std::string debugStr = "debug";
         const std::string arg(argv[2]);
@@ -215,7 +405,7 @@ void runProgram(CPU& cpu, const std::string& filename) {
     if (filename.size() > 4) {
         const std::string fileFormat = filename.substr(filename.size() - 4, 4);
         if (fileFormat == ".nes") {
-            cpu.readInINES(filename);
+            readInINES(cpu, filename);
             nesFile = true;
         }
     }
@@ -269,7 +459,7 @@ void runProgram(CPU& cpu, const std::string& filename) {
 
 void stepAndPrint(CPU& cpu, const bool showPPU) {
     cpu.print(false);
-    cpu.step(nullptr, nullptr);
+    cpu.step();
     cpu.print(true);
     if (showPPU) {
         cpu.printPPU();
@@ -282,31 +472,12 @@ void stepAndPrint(CPU& cpu, const bool showPPU) {
 void runInstTests(CPU& cpu, const std::vector<std::string>& filenames) {
     std::vector<unsigned int> failedTests;
     for (unsigned int testNum = 0; testNum < filenames.size(); ++testNum) {
-        const std::string& currentFilename = filenames[testNum];
-        const struct CPU::State state = readInState(currentFilename);
         if (testNum > 0) {
             cpu.clear();
         }
-        cpu.readInInst(currentFilename);
-        if (currentFilename.size() >= 13) {
-            const std::string testType = currentFilename.substr(10, 3);
-            // If the instruction test uses BRK, then the CPU can't halt the moment it reaches BRK
-            if (testType == "brk") {
-                cpu.setHaltAtBrk(false);
-            }
-        }
-        // The second group of conditions after the OR is for BRK instruction tests. The CPU will
-        // halt after reaching the same number of total cycles as the state file
-        while ((cpu.isHaltAtBrk() && !cpu.isEndOfProgram()) ||
-                (!cpu.isHaltAtBrk() && cpu.getTotalCycles() < state.totalCycles)) {
-            cpu.step(nullptr, nullptr);
-        }
-        if (!cpu.compareState(state)) {
+        if (!runInstTest(cpu, filenames[testNum])) {
             failedTests.push_back(testNum);
         }
-        if (!cpu.isHaltAtBrk()) {
-            cpu.setHaltAtBrk(true);
-        }
     }
 
     if (failedTests.size() != filenames.size()) {
@@ -321,6 +492,205 @@ void runInstTests(CPU& cpu, const std::vector<std::string>& filenames) {
     }
 }
 
+// Runs one instruction test on a CPU that has been cleared and compares the CPU's state with the
+// test's .state file. The CPU has to halt at BRK, which it does again afterwards. Returns true if
+// the states match
+
+bool runInstTest(CPU& cpu, const std::string& filename) {
+    const struct CPU::State state = readInState(filename);
+    cpu.readInInst(filename);
+    if (filename.size() >= 13) {
+        const std::string testType = filename.substr(10, 3);
+        // If the instruction test uses BRK, then the CPU can't halt the moment it reaches BRK
+        if (testType == "brk") {
+            cpu.setHaltAtBrk(false);
+        }
+    }
+    // The else branch is for BRK instruction tests. The CPU will halt after reaching the same
+    // number of total cycles as the state file
+    if (cpu.isHaltAtBrk()) {
+        while (cpu.runCycles(UINT_MAX) != CPU::ProgramEnded) { }
+    } else if (cpu.getTotalCycles() < state.totalCycles) {
+        cpu.runCycles(state.totalCycles - cpu.getTotalCycles());
+    }
+    const bool passed = cpu.compareState(state);
+    if (!cpu.isHaltAtBrk()) {
+        cpu.setHaltAtBrk(true);
+    }
+    return passed;
+}
+
+// Parses every made-up .NES file from getHeaderTests and checks that its header comes out as
+// expected, or that it's rejected if it isn't a whole .NES file. Files with a supported mapper are
+// also loaded and run for a frame, so that ones with odd sizes are read all the way through. Any
+// failed tests are printed out
+
+void runHeaderTests() {
+    const std::vector<struct HeaderTest> tests = getHeaderTests();
+    std::vector<std::string> failedTests;
+    for (const struct HeaderTest& test : tests) {
+        std::vector<uint8_t> file(test.fileBytes, 0);
+        std::copy_n(test.header.begin(), std::min(test.header.size(), file.size()), file.begin());
+        const uint8_t marker = 0xa5;
+        if (test.valid) {
+            file[test.prgROMOffset] = marker;
+        }
+        std::string error;
+        const std::shared_ptr<const ROMImage> image = ROMImage::fromMemory(file.data(),
+            file.size(), error);
+        bool passed = image == nullptr;
+        if (test.valid) {
+            passed = image != nullptr && compareHeaders(image->getHeader(), test.expected) &&
+                image->getPRGROM()[0] == marker;
+        }
+        if (passed && image != nullptr && NESCore::isSupported(*image)) {
+            NESCore core;
+            passed = core.load(image) && core.runFrame() == NESCore::FrameDone;
+        }
+        if (!passed) {
+            failedTests.push_back(test.name);
+        }
+    }
+
+    if (failedTests.size() != tests.size()) {
+        std::cout << "Passed " << tests.size() - failedTests.size() << " header tests\n";
+    }
+    for (const std::string& name : failedTests) {
+        std::cout << "Failed header test \"" << name << "\"\n";
+    }
+}
+
+// Covers the iNES and NES 2.0 fields that the emulator reads, plus files that have to be rejected.
+// The sizes are kept small so that the files only take a moment to make
+
+std::vector<struct HeaderTest> getHeaderTests() {
+    std::vector<struct HeaderTest> tests;
+    const uint16_t headerSize = 0x10;
+    const uint16_t trainerSize = 0x200;
+    const uint16_t prgBankSize = 0x4000;
+    const uint16_t chrBankSize = 0x2000;
+
+    struct HeaderTest* test = &addHeaderTest(tests, "iNES sizes, mapper, and flags",
+        {'N', 'E', 'S', 0x1a, 2, 1, 0x13, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        headerSize + prgBankSize * 2 + chrBankSize);
+    test->expected.prgROMBytes = prgBankSize * 2;
+    test->expected.chrROMBytes = chrBankSize;
+    test->expected.mapperID = 1;
+    test->expected.verticalMirroring = true;
+    test->expected.battery = true;
+
+    test = &addHeaderTest(tests, "iNES trainer and upper mapper bits",
+        {'N', 'E', 'S', 0x1a, 1, 0, 0x2c, 0x40, 0, 0, 0, 0, 0, 0, 0, 0},
+        headerSize + trainerSize + prgBankSize);
+    test->prgROMOffset = headerSize + trainerSize;
+    test->expected.prgROMBytes = prgBankSize;
+    test->expected.mapperID = 0x42;
+    test->expected.fourScreen = true;
+    test->expected.trainer = true;
+
+    // Only the lower half of the mapper ID is kept once there's text in bytes 12 - 15
+    test = &addHeaderTest(tests, "iNES with DiskDude!",
+        {'N', 'E', 'S', 0x1a, 1, 0, 0x20, 'D', 'i', 's', 'k', 'D', 'u', 'd', 'e', '!'},
+        headerSize + prgBankSize);
+    test->expected.prgROMBytes = prgBankSize;
+    test->expected.mapperID = 2;
+
+    // Unlike iNES, bytes 12 - 15 being used doesn't mask the mapper ID
+    test = &addHeaderTest(tests, "NES 2.0 mapper bits 8 - 11, submapper, and timing",
+        {'N', 'E', 'S', 0x1a, 1, 0, 0x10, 0x29, 0x53, 0, 0, 0, 1, 0, 0, 0},
+        headerSize + prgBankSize);
+    test->expected.nes20 = true;
+    test->expected.prgROMBytes = prgBankSize;
+    test->expected.mapperID = 0x321;
+    test->expected.submapperID = 5;
+    test->expected.timing = ROMImage::PAL;
+    test->expected.consoleType = 1;
+
+    test = &addHeaderTest(tests, "NES 2.0 ROM size upper bits",
+        {'N', 'E', 'S', 0x1a, 1, 1, 0, 0x08, 0, 0x10, 0, 0, 0, 0, 0, 0},
+        headerSize + prgBankSize + chrBankSize * 0x101);
+    test->expected.nes20 = true;
+    test->expected.prgROMBytes = prgBankSize;
+    test->expected.chrROMBytes = chrBankSize * 0x101;
+
+    // 2^12 * 3 bytes of PRG-ROM and 2^10 * 7 bytes of CHR-ROM, which aren't whole banks but are
+    // whole 4 KB PRG and 1 KB CHR slots
+    test = &addHeaderTest(tests, "NES 2.0 exponent-multiplier sizes",
+        {'N', 'E', 'S', 0x1a, (12 << 2) | 1, (10 << 2) | 3, 0, 0x08, 0, 0xff, 0, 0, 0, 0, 0, 0},
+        headerSize + 4096 * 3 + 1024 * 7);
+    test->expected.nes20 = true;
+    test->expected.prgROMBytes = 4096 * 3;
+    test->expected.chrROMBytes = 1024 * 7;
+
+    // Each size is 64 bytes shifted left by the shift count, or none if the count is 0
+    test = &addHeaderTest(tests, "NES 2.0 RAM shift counts",
+        {'N', 'E', 'S', 0x1a, 1, 0, 0, 0x08, 0, 0, 0x97, 0x70, 0, 0, 0, 0},
+        headerSize + prgBankSize);
+    test->expected.nes20 = true;
+    test->expected.prgROMBytes = prgBankSize;
+    test->expected.prgRAMBytes = 64 << 7;
+    test->expected.prgNVRAMBytes = 64 << 9;
+    test->expected.chrNVRAMBytes = 64 << 7;
+
+    // An exponent of 63 doesn't fit in a size_t
+    test = &addHeaderTest(tests, "NES 2.0 size that overflows",
+        {'N', 'E', 'S', 0x1a, 0xfc, 0, 0, 0x08, 0, 0x0f, 0, 0, 0, 0, 0, 0}, headerSize);
+    test->valid = false;
+
+    // 2^0 * 1 byte of PRG-ROM
+    test = &addHeaderTest(tests, "NES 2.0 PRG-ROM that isn't whole 4 KB slots",
+        {'N', 'E', 'S', 0x1a, 0, 0, 0, 0x08, 0, 0x0f, 0, 0, 0, 0, 0, 0}, headerSize + 1);
+    test->valid = false;
+
+    // 2^9 * 1 bytes of CHR-ROM
+    test = &addHeaderTest(tests, "NES 2.0 CHR-ROM that isn't whole 1 KB slots",
+        {'N', 'E', 'S', 0x1a, 1, 9 << 2, 0, 0x08, 0, 0xf0, 0, 0, 0, 0, 0, 0},
+        headerSize + prgBankSize + 512);
+    test->valid = false;
+
+    test = &addHeaderTest(tests, "Too short for a header", {'N', 'E', 'S', 0x1a}, 8);
+    test->valid = false;
+
+    test = &addHeaderTest(tests, "Not an iNES header",
+        {'N', 'E', 'S', 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, headerSize + prgBankSize);
+    test->valid = false;
+
+    test = &addHeaderTest(tests, "Shorter than the header says",
+        {'N', 'E', 'S', 0x1a, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+        headerSize + prgBankSize * 2 + chrBankSize - 1);
+    test->valid = false;
+
+    test = &addHeaderTest(tests, "No PRG-ROM",
+        {'N', 'E', 'S', 0x1a, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, headerSize + chrBankSize);
+    test->valid = false;
+    return tests;
+}
+
+// Adds a test for a file that should be parsed, whose expected header starts out as a blank iNES
+// header with the PRG-ROM right after it. Returns the test so that the expected fields can be
+// filled in before the next one is added
+
+struct HeaderTest& addHeaderTest(std::vector<struct HeaderTest>& tests, const std::string& name,
+        const std::vector<uint8_t>& header, const size_t fileBytes) {
+    const uint16_t headerSize = 0x10;
+    tests.push_back({name, header, fileBytes, true, headerSize, {}});
+    return tests.back();
+}
+
+bool compareHeaders(const struct ROMImage::Header& header,
+        const struct ROMImage::Header& expected) {
+    return header.nes20 == expected.nes20 && header.prgROMBytes == expected.prgROMBytes &&
+        header.chrROMBytes == expected.chrROMBytes && header.mapperID == expected.mapperID &&
+        header.submapperID == expected.submapperID &&
+        header.verticalMirroring == expected.verticalMirroring &&
+        header.fourScreen == expected.fourScreen && header.battery == expected.battery &&
+        header.trainer == expected.trainer && header.prgRAMBytes == expected.prgRAMBytes &&
+        header.prgNVRAMBytes == expected.prgNVRAMBytes &&
+        header.chrRAMBytes == expected.chrRAMBytes &&
+        header.chrNVRAMBytes == expected.chrNVRAMBytes && header.timing == expected.timing &&
+        header.consoleType == expected.consoleType;
+}
+
 void runNESTests(CPU& cpu) {
     runCPUTests(cpu);
     runPPUTests(cpu);
@@ -329,15 +699,154 @@ void runNESTests(CPU& cpu) {
 // Runs tests that are focused on the CPU
 
 void runCPUTests(CPU& cpu) {
-    const std::string filename = "test/nestest/nestest.nes";
+    for (const struct ROMTest& test : getCPUTests()) {
+        runROMTest(cpu, test, std::cout);
+    }
+}
+
+// Runs tests that are focused on the PPU
+
+void runPPUTests(CPU& cpu) {
+    for (const struct ROMTest& test : getPPUTests()) {
+        runROMTest(cpu, test, std::cout);
+    }
+}
+
+std::vector<struct ROMTest> getCPUTests() {
+    std::vector<struct ROMTest> tests;
+    tests.push_back({NESTestLog, "nestest/", "nestest.nes", 0, 0, 0, 0});
+    tests.push_back({ResultTest, "instr_test-v5/", "official_only.nes", 0xec5c, 0, 0, 0x6000});
+    // cpu_timing_test.nes doesn't store the test results anywhere as far as I know, so instead the
+    // test waits until the CPU reaches the "passed test" or the "failed test" branch in the program
+    tests.push_back({PCTest, "cpu_timing_test6/", "cpu_timing_test.nes", 0xe1b7, 0xe0b0, 0, 0});
+
+    const std::string branchDir = "branch_timing_tests/";
+    tests.push_back({ResultTest, branchDir, "1.Branch_Basics.nes", 0xe4f0, 0, 1, 0xf8});
+    tests.push_back({ResultTest, branchDir, "2.Backward_Branch.nes", 0xe4f0, 0, 1, 0xf8});
+    tests.push_back({ResultTest, branchDir, "3.Forward_Branch.nes", 0xe4f0, 0, 1, 0xf8});
+    return tests;
+}
+
+std::vector<struct ROMTest> getPPUTests() {
+    std::vector<struct ROMTest> tests;
+    const std::string nmiDir1 = "vbl_nmi_timing/";
+    const uint16_t zeroPageAddr = 0xf8;
+    tests.push_back({ResultTest, nmiDir1, "1.frame_basics.nes", 0xe589, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, nmiDir1, "2.vbl_timing.nes", 0xe54f, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, nmiDir1, "3.even_odd_frames.nes", 0xe59f, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, nmiDir1, "4.vbl_clear_timing.nes", 0xe535, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, nmiDir1, "5.nmi_suppression.nes", 0xe54c, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, nmiDir1, "6.nmi_disable.nes", 0xe535, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, nmiDir1, "7.nmi_timing.nes", 0xe58e, 0, 1, zeroPageAddr});
+
+    const std::string nmiDir2 = "ppu_vbl_nmi/rom_singles/";
+    const uint16_t prgRAMAddr = 0x6000;
+    tests.push_back({ResultTest, nmiDir2, "01-vbl_basics.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, nmiDir2, "02-vbl_set_time.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, nmiDir2, "03-vbl_clear_time.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, nmiDir2, "04-nmi_control.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, nmiDir2, "05-nmi_timing.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, nmiDir2, "06-suppression.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, nmiDir2, "07-nmi_on_timing.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, nmiDir2, "08-nmi_off_timing.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, nmiDir2, "09-even_odd_frames.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, nmiDir2, "10-even_odd_timing.nes", 0xead5, 0, 0, prgRAMAddr});
+
+    const std::string spriteHitDir1 = "sprite_hit_tests_2005.10.05/";
+    tests.push_back({ResultTest, spriteHitDir1, "01.basics.nes", 0xe635, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "02.alignment.nes", 0xe635, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "03.corners.nes", 0xe635, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "04.flip.nes", 0xe5b6, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "05.left_clip.nes", 0xe635, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "06.right_edge.nes", 0xe635, 0, 1, zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "07.screen_bottom.nes", 0xe635, 0, 1,
+        zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "08.double_height.nes", 0xe635, 0, 1,
+        zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "09.timing_basics.nes", 0xe64c, 0, 1,
+        zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "10.timing_order.nes", 0xe635, 0, 1,
+        zeroPageAddr});
+    tests.push_back({ResultTest, spriteHitDir1, "11.edge_timing.nes", 0xe635, 0, 1, zeroPageAddr});
+
+    const std::string spriteHitDir2 = "ppu_sprite_hit/rom_singles/";
+    tests.push_back({ResultTest, spriteHitDir2, "01-basics.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, spriteHitDir2, "02-alignment.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, spriteHitDir2, "03-corners.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, spriteHitDir2, "04-flip.nes", 0xe7d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, spriteHitDir2, "05-left_clip.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, spriteHitDir2, "06-right_edge.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, spriteHitDir2, "07-screen_bottom.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, spriteHitDir2, "08-double_height.nes", 0xe8d5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, spriteHitDir2, "09-timing.nes", 0xebd5, 0, 0, prgRAMAddr});
+    tests.push_back({ResultTest, spriteHitDir2, "10-timing_order.nes", 0xead5, 0, 0, prgRAMAddr});
+    return tests;
+}
+
+// Resets the CPU and runs one test ROM. Whether it passed (and why not, if it didn't) is printed to
+// out. Returns true if it passed
+
+bool runROMTest(CPU& cpu, const struct ROMTest& test, std::ostream& out) {
+    cpu.clear();
+    readInINES(cpu, "test/" + test.directory + test.name);
+    if (test.kind == NESTestLog) {
+        return runNESTestLog(cpu, out);
+    } else if (test.kind == PCTest) {
+        while (cpu.getPC() != test.stopPC && cpu.getPC() != test.failedPC) {
+            cpu.step();
+        }
+        if (cpu.getPC() == test.stopPC) {
+            out << "Passed " << test.directory << test.name << "\n";
+            return true;
+        }
+        out << "Failed " << test.directory << test.name << "\n";
+        return false;
+    }
+
+    // Runs the test until the CPU reaches the specified PC to stop at, then compares the test
+    // result with the known passed value
+    cpu.setBreakpoint(test.stopPC);
+    while (cpu.getPC() != test.stopPC) {
+        cpu.runCycles(UINT_MAX);
+    }
+    cpu.clearBreakpoint();
+
+    const uint8_t testResult = readMemory(cpu, test.testResultAddr);
+    if (testResult == test.passedTestResult) {
+        out << "Passed " << test.directory << test.name << "\n";
+        return true;
+    }
+    out << "Failed " << test.directory << test.name << ": 0x" << std::hex <<
+        (unsigned int) testResult << std::dec << "\n";
+    return false;
+}
+
+// Compares every instruction of nestest.nes with nestest.log, which the CPU has to have loaded.
+// Each instruction that doesn't match is printed to out. Returns true if all of them match
+
+bool runNESTestLog(CPU& cpu, std::ostream& out) {
     std::vector<struct CPU::State> states;
     std::vector<uint32_t> instructions;
     std::vector<std::string> testLogs;
-    cpu.readInINES(filename);
     readInNESTestStates(states, instructions, testLogs);
 
     unsigned int instNum = 0;
     bool passed = true;
+    // Instructions that are executed in one go can only be compared in between instructions, which
+    // is before the PC is incremented and the first cycle is counted for each line in the log
+    while (cpu.isFastInstructions() && !cpu.isEndOfProgram() && instNum < states.size()) {
+        struct CPU::State state = states[instNum];
+        --state.pc;
+        --state.totalCycles;
+        if (!cpu.compareState(state)) {
+            out << "Test log: " << testLogs[instNum] << "\nEmulator: ";
+            cpu.printStateInst(instructions[instNum], out);
+            out << "\n";
+            passed = false;
+        }
+        ++instNum;
+        cpu.runInstruction();
+    }
     while (!cpu.isEndOfProgram() && instNum < states.size()) {
         // Wait until the operation is 1 cycle in so that the addressing mode and operation
         // functions have been called once. This makes it easy to know which addressing mode and
@@ -348,14 +857,14 @@ void runCPUTests(CPU& cpu) {
             const uint32_t inst = cpu.getFutureInst();
             const std::string testLog = testLogs[instNum];
             if (!cpu.compareState(state) || inst != testInst) {
-                std::cout << "Test log: " << testLog << "\nEmulator: ";
-                cpu.printStateInst(inst);
-                std::cout << "\n";
+                out << "Test log: " << testLog << "\nEmulator: ";
+                cpu.printStateInst(inst, out);
+                out << "\n";
                 passed = false;
             }
             ++instNum;
         }
-        cpu.step(nullptr, nullptr);
+        cpu.step();
     }
 
     // nestest.nes puts a nonzero value in the RAM address $0002 if any valid opcodes fail and in
@@ -363,196 +872,843 @@ void runCPUTests(CPU& cpu) {
     // fails
     uint8_t testResult = cpu.readRAM(2);
     if (testResult != 0) {
-        std::cout << "Failed nestest.nes valid opcodes: 0x" << std::hex << (unsigned int) testResult
+        out << "Failed nestest.nes valid opcodes: 0x" << std::hex << (unsigned int) testResult
             << std::dec << "\n";
         passed = false;
     }
     testResult = cpu.readRAM(3);
     if (testResult != 0) {
-        std::cout << "Failed nestest/nestest.nes invalid opcodes: 0x" << std::hex <<
+        out << "Failed nestest/nestest.nes invalid opcodes: 0x" << std::hex <<
             (unsigned int) testResult << std::dec << "\n";
         passed = false;
     }
     if (passed) {
-        std::cout << "Passed nestest/nestest.nes\n";
+        out << "Passed nestest/nestest.nes\n";
     }
+    return passed;
+}
 
-    runIndividualTest(cpu, "official_only.nes", "instr_test-v5/", 0xec5c, 0, 0x6000);
+// Runs the instruction tests and the test ROMs on a pool of threads, where each thread has its own
+// CPU, and prints a JSON summary of whether each test passed, how many CPU cycles it ran for, and
+// how long it took. The test ROMs take far longer than the instruction tests, so they're started
+// first and are listed first. The argument after "tests" is threads=N (the number of hardware
+// threads by default). Exits with 1 after the summary if any test failed, so that scripts can tell
+
+void runParallelTests(int argc, char* argv[], const std::vector<std::string>& cpuOptions) {
+    unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    OptionParser parser("test", argc, argv, 2);
+    while (parser.next()) {
+        if (parser.getKey() != "threads") {
+            parser.reject();
+        }
+        threadCount = std::max(parser.getNumber(10, UINT_MAX), 1u);
+    }
+    std::vector<struct ROMTest> romTests = getCPUTests();
+    const std::vector<struct ROMTest> ppuTests = getPPUTests();
+    romTests.insert(romTests.end(), ppuTests.begin(), ppuTests.end());
+    std::vector<std::string> filenames;
+    readInFilenames(filenames);
+    const unsigned int testCount = romTests.size() + filenames.size();
+
+    // Each worker claims the next test that hasn't been started until there are none left
+    std::vector<struct TestResult> results(testCount);
+    std::atomic<unsigned int> nextTest(0);
+    const auto work = [&]() {
+        // The CPU is on the heap since it's hundreds of KB
+        std::unique_ptr<CPU> cpu = std::make_unique<CPU>();
+        for (const std::string& option : cpuOptions) {
+            cpu->setOption(option);
+        }
+        unsigned int test = nextTest.fetch_add(1, std::memory_order_relaxed);
+        while (test < testCount) {
+            struct TestResult& result = results[test];
+            std::ostringstream out;
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (test < romTests.size()) {
+                cpu->setHaltAtBrk(false);
+                result.name = romTests[test].directory + romTests[test].name;
+                result.passed = runROMTest(*cpu, romTests[test], out);
+            } else {
+                // The end of the instruction tests are when the program reaches zeroed out
+                // memory, and the BRK instruction is 0
+                const std::string& filename = filenames[test - romTests.size()];
+                cpu->clear();
+                cpu->setHaltAtBrk(true);
+                result.name = filename.substr(5);
+                result.passed = runInstTest(*cpu, filename);
+                if (!result.passed) {
+                    out << "Failed test \"" << result.name << "\"\n";
+                }
+            }
+            result.seconds = std::chrono::duration_cast<std::chrono::duration<double>>(
+                std::chrono::steady_clock::now() - start).count();
+            result.cycles = cpu->getTotalCycles();
+            result.output = out.str();
+            test = nextTest.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(
+        std::chrono::steady_clock::now() - start).count();
 
-    // cpu_timing_test.nes doesn't store the test results anywhere as far as I know, so instead the
-    // while loop waits until the CPU reaches the "passed test" or the "failed test" branch in the
-    // program
-    cpu.clear();
-    cpu.readInINES("test/cpu_timing_test6/cpu_timing_test.nes");
-    const uint16_t passedPC = 0xe1b7;
-    const uint16_t failedPC = 0xe0b0;
-    while (cpu.getPC() != passedPC && cpu.getPC() != failedPC) {
-        cpu.step(nullptr, nullptr);
+    unsigned int passedTests = 0;
+    for (const struct TestResult& result : results) {
+        if (result.passed) {
+            ++passedTests;
+        }
+    }
+    std::cout << "{\n  \"threads\": " << threadCount << ",\n  \"seconds\": " << seconds <<
+        ",\n  \"passed\": " << passedTests << ",\n  \"failed\": " << testCount - passedTests <<
+        ",\n  \"tests\": [\n";
+    for (unsigned int i = 0; i < testCount; ++i) {
+        const struct TestResult& result = results[i];
+        std::cout << "    {\"name\": ";
+        writeJSONString(std::cout, result.name);
+        std::cout << ", \"passed\": " << std::boolalpha << result.passed << std::noboolalpha <<
+            ", \"cycles\": " << result.cycles << ", \"seconds\": " << result.seconds;
+        // Passed tests don't print anything that isn't already in the summary
+        if (!result.passed) {
+            std::cout << ", \"output\": ";
+            writeJSONString(std::cout, result.output);
+        }
+        std::cout << "}";
+        if (i + 1 < testCount) {
+            std::cout << ",";
+        }
+        std::cout << "\n";
     }
+    std::cout << "  ]\n}\n";
+    if (passedTests != testCount) {
+        exit(1);
+    }
+}
 
-    if (cpu.getPC() == passedPC) {
-        std::cout << "Passed cpu_timing_test6/cpu_timing_test.nes\n";
-    } else {
-        std::cout << "Failed cpu_timing_test6/cpu_timing_test.nes\n";
+// Writes a string as a JSON string literal, escaping the characters that JSON doesn't allow in one
+
+void writeJSONString(std::ostream& out, const std::string& str) {
+    out << "\"";
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            out << "\\" << c;
+        } else if (c == '\n') {
+            out << "\\n";
+        } else if ((unsigned char) c < 0x20) {
+            const char* hexDigits = "0123456789abcdef";
+            out << "\\u00" << hexDigits[c >> 4] << hexDigits[c & 0xf];
+        } else {
+            out << c;
+        }
     }
+    out << "\"";
+}
 
-    const std::string branchDir = "branch_timing_tests/";
-    runIndividualTest(cpu, "1.Branch_Basics.nes", branchDir, 0xe4f0, 1, 0xf8);
-    runIndividualTest(cpu, "2.Backward_Branch.nes", branchDir, 0xe4f0, 1, 0xf8);
-    runIndividualTest(cpu, "3.Forward_Branch.nes", branchDir, 0xe4f0, 1, 0xf8);
+// Runs the .NES file with graphics and I/O. SDL's events and rendering stay on the main thread,
+// which is the only thread that they work on for some platforms (e.g., macOS), and the emulation
+// runs on a thread of its own that hands its frames off to the main thread
+
+void runNESGame(NESCore& core, const std::string& filename) {
+    core.load(readInROM(filename));
+
+    SDL_Init(SDL_INIT_EVERYTHING);
+    SDL_Window* window = SDL_CreateWindow("SDL2", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+        NESCore::frameWidth, NESCore::frameHeight, SDL_WINDOW_OPENGL);
+    if (window == nullptr) {
+        std::cerr << "Could not create window\n" << SDL_GetError();
+        exit(1);
+    }
+    FramePresenter presenter(window);
+    presenter.start();
+
+    struct GameControls controls;
+    struct FrameTimes frameTimes;
+    std::thread emulationThread(runEmulation, std::ref(core), std::ref(presenter),
+        std::cref(controls), std::ref(frameTimes));
+    SDL_Event event;
+    while (controls.running) {
+        // Listen for keypresses and pass them off to the emulation thread
+        while (SDL_PollEvent(&event)) {
+            switch (event.type) {
+                case SDL_KEYDOWN:
+                    controls.buttons |= getButton(event.key.keysym.sym);
+                    if (event.key.keysym.sym == SDLK_BACKSPACE) {
+                        controls.rewinding = true;
+                    }
+                    // Holding the key down sends repeated key presses, which are ignored
+                    if (event.key.keysym.sym == SDLK_TAB && event.key.repeat == 0) {
+                        controls.fastForwarding = !controls.fastForwarding;
+                    }
+                    break;
+                case SDL_KEYUP:
+                    controls.buttons &= ~getButton(event.key.keysym.sym);
+                    if (event.key.keysym.sym == SDLK_BACKSPACE) {
+                        controls.rewinding = false;
+                    }
+                    break;
+                case SDL_QUIT:
+                    controls.running = false;
+            }
+        }
+        presenter.presentFrame();
+    }
+    // The presenter's textures are destroyed once the emulation thread is done converting frames
+    // into them
+    emulationThread.join();
+    presenter.stop();
+    presenter.printStats();
+    printRunAheadStats(core, frameTimes);
+
+    SDL_DestroyWindow(window);
+    SDL_Quit();
 }
 
-// Runs tests that are focused on the PPU
+// Main loop of the emulation thread. Runs a frame at a time at the frame rate of the console until
+// the window is closed, with the controls that the main thread read in from the keyboard
+
+void runEmulation(NESCore& core, FramePresenter& presenter, const struct GameControls& controls,
+        struct FrameTimes& frameTimes) {
+    // Frame rate of the NTSC NES
+    const double frameRate = 60.0988;
+    FrameScheduler scheduler(frameRate);
+    // The last minute of frames can be rewound through
+    const unsigned int rewindFrames = 3600;
+    const unsigned int keyframeInterval = 60;
+    RewindBuffer rewindBuffer(rewindFrames, keyframeInterval);
+    // Number of frames that are run for every frame that's displayed while fast-forwarding
+    const unsigned int fastForwardSpeed = 4;
+    scheduler.start();
+    while (controls.running) {
+        core.setInput(0, controls.buttons);
+        // A frame can only be displayed by running it, so rewinding by one frame goes back two
+        // frames and runs the second one again. Once the oldest frame is reached, it's repeated
+        if (controls.rewinding && rewindBuffer.getFrameCount() != 0) {
+            rewindBuffer.rewind(core, std::min(rewindBuffer.getFrameCount() - 1, 2u));
+        } else if (controls.fastForwarding) {
+            // Only the last of the frames is displayed, so the ones before it skip the output
+            core.setFrameOutput(false);
+            for (unsigned int i = 1; i < fastForwardSpeed; ++i) {
+                core.runFrame();
+                rewindBuffer.push(core);
+            }
+            core.setFrameOutput(true);
+        }
+        // Run CPU (and other components) for however many cycles it takes to render one frame.
+        // The input is only read in once per frame since the main thread only polls for it about
+        // that often. The frame is converted straight into the presenter's back buffer
+        core.setFrameBuffer(presenter.getBackBuffer(), presenter.getBackBufferPitch());
+        const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+        const NESCore::RunResult result = core.runFrame();
+        addFrameTime(frameTimes, std::chrono::steady_clock::now() - frameStart);
+        if (result == NESCore::FrameDone) {
+            presenter.submitFrame();
+        }
+        rewindBuffer.push(core);
 
-void runPPUTests(CPU& cpu) {
-    const std::string nmiDir1 = "vbl_nmi_timing/";
-    const uint16_t zeroPageAddr = 0xf8;
-    runIndividualTest(cpu, "1.frame_basics.nes", nmiDir1, 0xe589, 1, zeroPageAddr);
-    runIndividualTest(cpu, "2.vbl_timing.nes", nmiDir1, 0xe54f, 1, zeroPageAddr);
-    runIndividualTest(cpu, "3.even_odd_frames.nes", nmiDir1, 0xe59f, 1, zeroPageAddr);
-    runIndividualTest(cpu, "4.vbl_clear_timing.nes", nmiDir1, 0xe535, 1, zeroPageAddr);
-    runIndividualTest(cpu, "5.nmi_suppression.nes", nmiDir1, 0xe54c, 1, zeroPageAddr);
-    runIndividualTest(cpu, "6.nmi_disable.nes", nmiDir1, 0xe535, 1, zeroPageAddr);
-    runIndividualTest(cpu, "7.nmi_timing.nes", nmiDir1, 0xe58e, 1, zeroPageAddr);
+        // Wait until it's time to render the next frame
+        scheduler.waitForNextFrame();
+    }
+    core.setFrameBuffer(nullptr, 0);
+    scheduler.printStats();
+}
 
-    const std::string nmiDir2 = "ppu_vbl_nmi/rom_singles/";
-    const uint16_t prgRAMAddr = 0x6000;
-    runIndividualTest(cpu, "01-vbl_basics.nes", nmiDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "02-vbl_set_time.nes", nmiDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "03-vbl_clear_time.nes", nmiDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "04-nmi_control.nes", nmiDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "05-nmi_timing.nes", nmiDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "06-suppression.nes", nmiDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "07-nmi_on_timing.nes", nmiDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "08-nmi_off_timing.nes", nmiDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "09-even_odd_frames.nes", nmiDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "10-even_odd_timing.nes", nmiDir2, 0xead5, 0, prgRAMAddr);
+// Reads in a whole file in one go
 
-    const std::string spriteHitDir1 = "sprite_hit_tests_2005.10.05/";
-    runIndividualTest(cpu, "01.basics.nes", spriteHitDir1, 0xe635, 1, zeroPageAddr);
-    runIndividualTest(cpu, "02.alignment.nes", spriteHitDir1, 0xe635, 1, zeroPageAddr);
-    runIndividualTest(cpu, "03.corners.nes", spriteHitDir1, 0xe635, 1, zeroPageAddr);
-    runIndividualTest(cpu, "04.flip.nes", spriteHitDir1, 0xe5b6, 1, zeroPageAddr);
-    runIndividualTest(cpu, "05.left_clip.nes", spriteHitDir1, 0xe635, 1, zeroPageAddr);
-    runIndividualTest(cpu, "06.right_edge.nes", spriteHitDir1, 0xe635, 1, zeroPageAddr);
-    runIndividualTest(cpu, "07.screen_bottom.nes", spriteHitDir1, 0xe635, 1, zeroPageAddr);
-    runIndividualTest(cpu, "08.double_height.nes", spriteHitDir1, 0xe635, 1, zeroPageAddr);
-    runIndividualTest(cpu, "09.timing_basics.nes", spriteHitDir1, 0xe64c, 1, zeroPageAddr);
-    runIndividualTest(cpu, "10.timing_order.nes", spriteHitDir1, 0xe635, 1, zeroPageAddr);
-    runIndividualTest(cpu, "11.edge_timing.nes", spriteHitDir1, 0xe635, 1, zeroPageAddr);
+std::vector<uint8_t> readInFile(const std::string& filename) {
+    std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Error reading in file\n";
+        exit(1);
+    }
+    std::vector<uint8_t> data(file.tellg());
+    file.seekg(0);
+    file.read((char*) data.data(), data.size());
+    file.close();
+    return data;
+}
 
-    const std::string spriteHitDir2 = "ppu_sprite_hit/rom_singles/";
-    runIndividualTest(cpu, "01-basics.nes", spriteHitDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "02-alignment.nes", spriteHitDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "03-corners.nes", spriteHitDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "04-flip.nes", spriteHitDir2, 0xe7d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "05-left_clip.nes", spriteHitDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "06-right_edge.nes", spriteHitDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "07-screen_bottom.nes", spriteHitDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "08-double_height.nes", spriteHitDir2, 0xe8d5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "09-timing.nes", spriteHitDir2, 0xebd5, 0, prgRAMAddr);
-    runIndividualTest(cpu, "10-timing_order.nes", spriteHitDir2, 0xead5, 0, prgRAMAddr);
-}
-
-// Runs an individual .NES test until the CPU reaches the specified PC to stop at, then compares the
-// test result with the known passed value to determine whether the test passed or not
-
-void runIndividualTest(CPU& cpu, const std::string& testName, const std::string& testDirectory,
-        const uint16_t stopPC, const uint8_t passedTestResult, const uint16_t testResultAddr) {
-    cpu.clear();
-    cpu.readInINES("test/" + testDirectory + testName);
-    while (cpu.getPC() != stopPC) {
-        cpu.step(nullptr, nullptr);
+// Maps an .NES file into memory. Exits if it isn't a .NES file that NESCore can load
+
+std::shared_ptr<const ROMImage> readInROM(const std::string& filename) {
+    std::string error;
+    const std::shared_ptr<const ROMImage> rom = ROMImage::fromFile(filename, error);
+    if (rom == nullptr) {
+        std::cerr << error << "\n";
+        exit(1);
+    }
+    if (!NESCore::isSupported(*rom)) {
+        std::cerr << "Only mappers 0, 1, 2, 3, and 7 are supported\n";
+        exit(1);
     }
+    return rom;
+}
 
-    uint8_t testResult;
-    if (testResultAddr < 0x2000) {
-        testResult = cpu.readRAM(testResultAddr);
-    } else if (testResultAddr >= 0x4020) {
-        testResult = cpu.readPRG(testResultAddr);
-    } else {
-        std::cerr << "Invalid test result address\n";
+// Loads an .NES file into a CPU of its own. Exits if it isn't a .NES file that can be loaded
+
+void readInINES(CPU& cpu, const std::string& filename) {
+    std::string error;
+    if (!cpu.readInINES(filename, error)) {
+        std::cerr << error << "\n";
         exit(1);
     }
+}
 
-    if (testResult == passedTestResult) {
-        std::cout << "Passed " << testDirectory << testName << "\n";
-    } else {
-        std::cout << "Failed " << testDirectory << testName << ": 0x" << std::hex <<
-            (unsigned int) testResult << std::dec << "\n";
+// Maps keyboard keys to joystick buttons. Returns 0 if the key isn't mapped to a button
+
+uint8_t getButton(const SDL_Keycode key) {
+    switch (key) {
+        case SDLK_x:
+            return IO::ButtonA;
+        case SDLK_z:
+            return IO::ButtonB;
+        case SDLK_UP:
+            return IO::ButtonUp;
+        case SDLK_DOWN:
+            return IO::ButtonDown;
+        case SDLK_LEFT:
+            return IO::ButtonLeft;
+        case SDLK_RIGHT:
+            return IO::ButtonRight;
+        case SDLK_RETURN:
+            return IO::ButtonStart;
+        case SDLK_RSHIFT:
+            return IO::ButtonSelect;
     }
+    return 0;
 }
 
-// Runs the .NES file with graphics and I/O
+// Converts the arguments after "headless" into stop conditions. Each argument is in the form of
+// frames=N (decimal), pc=XXXX (hexadecimal), or ram=XXXX:YY (hexadecimal address and value), where
+// the address has to be in the RAM ($0000 - $1fff) or the cartridge ($4020 - $ffff).
+// fastforward=N (decimal) only outputs every Nth frame
+
+struct HeadlessOptions readInHeadlessOptions(int argc, char* argv[]) {
+    struct HeadlessOptions options;
+    OptionParser parser("headless", argc, argv, 3);
+    while (parser.next()) {
+        const std::string& key = parser.getKey();
+        if (key == "frames") {
+            options.frames = parser.getNumber(10, UINT_MAX);
+        } else if (key == "fastforward") {
+            options.fastForward = std::max(parser.getNumber(10, UINT_MAX), 1u);
+        } else if (key == "pc") {
+            options.stopAtPC = true;
+            options.stopPC = parser.getNumber(16, UINT16_MAX);
+        } else if (key == "ram") {
+            const std::string& val = parser.getValue();
+            const size_t colonIndex = val.find(':');
+            if (colonIndex == std::string::npos) {
+                std::cerr << "RAM condition should be in the form of ram=XXXX:YY\n";
+                exit(1);
+            }
+            unsigned int addr = 0;
+            unsigned int stopVal = 0;
+            if (!OptionParser::parseNumber(val.substr(0, colonIndex), 16, UINT16_MAX, addr) ||
+                    !OptionParser::parseNumber(val.substr(colonIndex + 1), 16, UINT8_MAX,
+                    stopVal)) {
+                parser.reject();
+            }
+            // The registers in between can't be read without side effects, so NESCore reads them
+            // as 0 and the condition could never be met
+            const uint16_t ramEnd = 0x2000;
+            const uint16_t cartridgeStart = 0x4020;
+            if (addr >= ramEnd && addr < cartridgeStart) {
+                std::cerr << "Address 0x" << std::hex << addr << std::dec << " is not in the RAM "
+                    "or cartridge\n";
+                exit(1);
+            }
+            options.stopAtVal = true;
+            options.stopAddr = addr;
+            options.stopVal = stopVal;
+        } else {
+            parser.reject();
+        }
+    }
+    if (options.frames == 0 && !options.stopAtPC && !options.stopAtVal) {
+        std::cerr << "Headless mode needs at least one of frames=N, pc=XXXX, or ram=XXXX:YY\n";
+        exit(1);
+    }
+    return options;
+}
 
-void runNESGame(CPU& cpu, const std::string& filename) {
-    cpu.readInINES(filename);
+// Runs the .NES file as fast as possible without SDL until one of the stop conditions is met, then
+// reports how fast the emulator ran. Exits with 1 if a PC or RAM condition was given but the frame
+// limit was reached first, so that batch scripts can tell the two apart
 
-    const unsigned int frameWidth = 256;
-    const unsigned int frameHeight = 240;
-    SDL_Init(SDL_INIT_EVERYTHING);
-    SDL_Window* window = SDL_CreateWindow("SDL2", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-        frameWidth, frameHeight, SDL_WINDOW_OPENGL);
-    if (window == nullptr) {
-        std::cerr << "Could not create window\n" << SDL_GetError();
+void runHeadless(NESCore& core, const std::string& filename,
+        const struct HeadlessOptions& options) {
+    core.load(readInROM(filename));
+    if (options.stopAtPC) {
+        core.setBreakpoint(options.stopPC);
+    }
+
+    unsigned int frames = 0;
+    // Total CPU cycles is a 32-bit value that wraps around during long runs, so the number of
+    // cycles is accumulated from the difference between each frame instead
+    uint64_t cycles = 0;
+    bool conditionMet = false;
+    struct FrameTimes frameTimes;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (!conditionMet && (options.frames == 0 || frames < options.frames)) {
+        const unsigned int startCycles = core.getTotalCycles();
+        const bool output = (frames + 1) % options.fastForward == 0;
+        core.setFrameOutput(output);
+        const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+        const NESCore::RunResult result = core.runFrame();
+        if (output) {
+            addFrameTime(frameTimes, std::chrono::steady_clock::now() - frameStart);
+        }
+        if (result == NESCore::BreakpointHit) {
+            conditionMet = true;
+        }
+        cycles += core.getTotalCycles() - startCycles;
+        ++frames;
+        if (options.stopAtVal && core.readMemory(options.stopAddr) == options.stopVal) {
+            conditionMet = true;
+        }
+    }
+    const std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(finish -
+        start).count();
+
+    if (conditionMet) {
+        std::cout << "Stop condition met at PC 0x" << std::hex << core.getPC() << std::dec <<
+            "\n";
+    }
+    std::cout << "Ran " << frames << " frames (" << cycles << " CPU cycles) in " << seconds <<
+        " seconds\n";
+    if (seconds > 0) {
+        std::cout << "Frames per second: " << frames / seconds << "\n"
+            "CPU cycles per second: " << (uint64_t) (cycles / seconds) << "\n";
+    }
+    printRunAheadStats(core, frameTimes);
+    if (!conditionMet && (options.stopAtPC || options.stopAtVal)) {
+        std::cout << "Frame limit reached before the stop condition was met\n";
         exit(1);
     }
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    if (renderer == nullptr) {
-        std::cerr << "Could not create renderer\n" << SDL_GetError();
+}
+
+// Times the PPU on its own for the number of frames in frames=N. The .NES file is run normally for
+// a few seconds beforehand so that the game has set up its nametables, palettes, and sprites, and
+// then only the PPU is run while the CPU stays paused
+
+void runPPUBenchmark(CPU& cpu, const std::string& filename, int argc, char* argv[]) {
+    unsigned int frames = 0;
+    OptionParser parser("PPU benchmark", argc, argv, 3);
+    while (parser.next()) {
+        if (parser.getKey() != "frames") {
+            parser.reject();
+        }
+        frames = parser.getNumber(10, UINT_MAX);
+    }
+    if (frames == 0) {
+        std::cerr << "PPU benchmark needs frames=N\n";
         exit(1);
     }
-    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
-        SDL_TEXTUREACCESS_STREAMING, frameWidth, frameHeight);
-    if (texture == nullptr) {
-        std::cerr << "Could not create texture\n" << SDL_GetError();
+    readInINES(cpu, filename);
+    const unsigned int warmUpFrames = 180;
+    for (unsigned int i = 0; i < warmUpFrames; ++i) {
+        cpu.runFrame();
+    }
+
+    const uint64_t cyclesPerFrame = 341 * 262;
+    const uint64_t cycles = cyclesPerFrame * frames;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < frames; ++i) {
+        cpu.runPPUCycles(cyclesPerFrame);
+    }
+    const std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(finish -
+        start).count();
+
+    std::cout << "Ran the PPU for " << frames << " frames (" << cycles << " PPU cycles) in " <<
+        seconds << " seconds\n";
+    if (seconds > 0) {
+        std::cout << "Frames per second: " << frames / seconds << "\n"
+            "Nanoseconds per PPU cycle: " << seconds * 1e9 / cycles << "\n";
+    }
+}
+
+// Runs many instances of the .NES file at once with a BatchRunner and reports how well it scales
+// across threads. The arguments after "batch" are instances=N (64 by default), frames=N (600 by
+// default), threads=N, and observe=frame or observe=ram (frame by default). Without threads=N, it's
+// measured with 1, 2, 4, etc. threads up to the number of hardware threads. The CPU options are
+// applied to every instance
+
+void runBatchBenchmark(const std::string& filename, int argc, char* argv[],
+        const std::vector<std::string>& cpuOptions) {
+    unsigned int instances = 64;
+    unsigned int frames = 600;
+    unsigned int maxThreads = 0;
+    unsigned int observation = BatchRunner::FrameObservations;
+    OptionParser parser("batch", argc, argv, 3);
+    while (parser.next()) {
+        const std::string& key = parser.getKey();
+        if (key == "instances") {
+            instances = parser.getNumber(10, UINT_MAX);
+        } else if (key == "frames") {
+            frames = parser.getNumber(10, UINT_MAX);
+        } else if (key == "threads") {
+            maxThreads = parser.getNumber(10, UINT_MAX);
+        } else if (key == "observe" && parser.getValue() == "frame") {
+            observation = BatchRunner::FrameObservations;
+        } else if (key == "observe" && parser.getValue() == "ram") {
+            observation = BatchRunner::RAMObservations;
+        } else {
+            parser.reject();
+        }
+    }
+    if (instances == 0 || frames == 0) {
+        std::cerr << "Batch mode needs at least one instance and one frame\n";
         exit(1);
     }
 
-    SDL_Event event;
-    bool running = true;
-    while (running) {
+    // Always measure with 1 thread, since scaling is relative to it
+    std::vector<unsigned int> threadCounts = {1};
+    if (maxThreads > 1) {
+        threadCounts.push_back(maxThreads);
+    } else if (maxThreads == 0) {
+        const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        for (unsigned int threads = 2; threads < hardwareThreads; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        if (hardwareThreads > 1) {
+            threadCounts.push_back(hardwareThreads);
+        }
+    }
+
+    // The ROM is only mapped into memory once and shared by every run and instance
+    const std::shared_ptr<const ROMImage> rom = readInROM(filename);
+    std::cout << "Running " << instances << " instances for " << frames << " frames\n";
+    double singleThreadRate = 0;
+    for (const unsigned int threads : threadCounts) {
+        BatchRunner runner(rom, instances, threads, observation);
+        for (unsigned int i = 0; i < instances; ++i) {
+            for (const std::string& option : cpuOptions) {
+                runner.getInstance(i).setOption(option);
+            }
+        }
+
         const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
-        unsigned int ppuCycles = cpu.getTotalPPUCycles();
-        const unsigned int ppuCyclesPerFrame = 341 * 262;
-        // Ensure that the total PPU cycles will always be less than ppuCycles + ppuCyclesPerFrame
-        if (ppuCycles > UINT_MAX - ppuCyclesPerFrame) {
-            cpu.clearTotalPPUCycles();
-            ppuCycles = cpu.getTotalPPUCycles();
+        for (unsigned int i = 0; i < frames; ++i) {
+            runner.runFrame();
         }
-        // Run CPU (and other components) for however many cycles it takes to render one frame
-        // without polling for I/O. I/O is polled only every frame rather than anything more
-        // frequent (e.g., every CPU cycle) to reduce the lag from calling SDL_PollEvent too much
-        while (cpu.getTotalPPUCycles() < ppuCycles + ppuCyclesPerFrame) {
-            cpu.step(renderer, texture);
+        const std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(finish -
+            start).count();
+
+        // Checksum of the last observations (FNV-1a), which should be the same for every thread
+        // count since the instances are independent
+        const uint32_t checksum = hashBytes(runner.getObservations(),
+            runner.getObservationStride() * instances, hashStart);
+
+        const double rate = (double) instances * frames / seconds;
+        if (threads == 1) {
+            singleThreadRate = rate;
         }
+        const double speedup = rate / singleThreadRate;
+        std::cout << "Threads: " << threads << ", frames per second: " << rate << ", speedup: " <<
+            speedup << ", scaling efficiency: " << speedup / threads * 100 <<
+            "%, observation checksum: " << std::hex << checksum << std::dec << "\n";
+    }
+}
 
-        // Listen for keypresses and pass them off to the I/O class
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-                case SDL_KEYDOWN:
-                    cpu.updateButton(event);
-                    break;
-                case SDL_KEYUP:
-                    cpu.updateButton(event);
-                    break;
-                case SDL_QUIT:
-                    running = false;
+// Loads every .NES file in the path (a file, or a directory that's searched recursively) into a
+// machine over and over and reports how long each load takes and how many allocations it makes.
+// Both ways of making a ROM image are measured: mapping the file, and reading the file in one call
+// and copying it. The argument after "loadbench" is loads=N (100 by default). Files with
+// unsupported mappers are only turned into ROM images
+
+void runLoadBenchmark(const std::string& path, int argc, char* argv[]) {
+    unsigned int loads = 100;
+    OptionParser parser("load benchmark", argc, argv, 3);
+    while (parser.next()) {
+        if (parser.getKey() != "loads") {
+            parser.reject();
+        }
+        loads = parser.getNumber(10, UINT_MAX);
+    }
+
+    std::vector<std::string> filenames;
+    if (std::filesystem::is_directory(path)) {
+        for (const std::filesystem::directory_entry& entry :
+                std::filesystem::recursive_directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".nes") {
+                filenames.push_back(entry.path().string());
             }
         }
+    } else {
+        filenames.push_back(path);
+    }
+    if (filenames.empty() || loads == 0) {
+        std::cerr << "Load benchmark needs at least one .NES file and one load\n";
+        exit(1);
+    }
 
-        std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
-        // Frame rate of the NTSC NES
-        const double frameRate = 60.0988;
-        // Wait until it's time to render the next frame. While there's probably a more optimal way
-        // to limit frames, this implementation is simple and accurate
-        while (std::chrono::duration_cast<std::chrono::duration<double>>(finish - start).count() <
-                1 / frameRate) {
-            finish = std::chrono::steady_clock::now();
+    std::cout << "Loading " << filenames.size() << " .NES files " << loads << " times each\n";
+    NESCore core;
+    for (const bool mapped : {true, false}) {
+        const uint64_t startAllocations = getAllocationCount();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < loads; ++i) {
+            for (const std::string& filename : filenames) {
+                std::shared_ptr<const ROMImage> rom;
+                std::string error;
+                if (mapped) {
+                    rom = ROMImage::fromFile(filename, error);
+                } else {
+                    const std::vector<uint8_t> data = readInFile(filename);
+                    rom = ROMImage::fromMemory(data.data(), data.size(), error);
+                }
+                if (rom == nullptr) {
+                    std::cerr << filename << ": " << error << "\n";
+                    exit(1);
+                }
+                // ROMs with unsupported mappers are still parsed but aren't loaded
+                core.load(rom);
+            }
         }
+        const std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+        const uint64_t allocations = getAllocationCount() - startAllocations;
+        const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(finish -
+            start).count();
+
+        const double loadCount = (double) loads * filenames.size();
+        if (mapped) {
+            std::cout << "Mapped: ";
+        } else {
+            std::cout << "Read and copied: ";
+        }
+        std::cout << seconds * 1e6 / loadCount << " microseconds per load, " <<
+            allocations / loadCount << " allocations per load\n";
     }
+}
 
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
-}
\ No newline at end of file
+// Measures how long it takes to save and load the whole machine, and checks that loading a state
+// brings the machine back to exactly where it was. The .NES file is run for 60 frames and half of a
+// frame, so that the state is saved in the middle of a frame, and then for N more frames (600 by
+// default). The state is loaded and the N frames are run again, where each frame and the RAM after
+// it have to come out the same, even though a cut-off state is rejected in between.
+// The argument after "statebench" is frames=N
+
+void runStateBenchmark(NESCore& core, const std::string& filename, int argc, char* argv[]) {
+    unsigned int frames = 600;
+    OptionParser parser("state benchmark", argc, argv, 3);
+    while (parser.next()) {
+        if (parser.getKey() != "frames") {
+            parser.reject();
+        }
+        frames = parser.getNumber(10, UINT_MAX);
+    }
+    core.load(readInROM(filename));
+    const unsigned int warmUpFrames = 60;
+    for (unsigned int i = 0; i < warmUpFrames; ++i) {
+        core.runFrame();
+    }
+    const unsigned int halfFrameCycles = 341 * 262 / 3 / 2;
+    core.runCycles(halfFrameCycles);
+
+    std::vector<uint8_t> state;
+    core.saveState(state);
+    std::vector<uint32_t> outputHashes;
+    for (unsigned int i = 0; i < frames; ++i) {
+        core.runFrame();
+        outputHashes.push_back(core.hashOutput());
+    }
+
+    // Both are repeated since a single save or load is too quick to time on its own. The machine
+    // ends up where the state was saved
+    const unsigned int trials = 10000;
+    std::vector<uint8_t> trialState;
+    const std::chrono::steady_clock::time_point saveStart = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < trials; ++i) {
+        core.saveState(trialState);
+    }
+    const std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < trials; ++i) {
+        if (!core.loadState(state.data(), state.size())) {
+            std::cerr << "Could not load the state\n";
+            exit(1);
+        }
+    }
+    const std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+    // A cut-off state has to be rejected without changing the machine, which the frames after it
+    // check
+    if (core.loadState(state.data(), state.size() / 2)) {
+        std::cerr << "A cut-off state was loaded\n";
+        exit(1);
+    }
+    const double saveSeconds = std::chrono::duration_cast<std::chrono::duration<double>>(loadStart
+        - saveStart).count();
+    const double loadSeconds = std::chrono::duration_cast<std::chrono::duration<double>>(finish -
+        loadStart).count();
+
+    unsigned int mismatchedFrames = 0;
+    for (unsigned int i = 0; i < frames; ++i) {
+        core.runFrame();
+        if (core.hashOutput() != outputHashes[i]) {
+            ++mismatchedFrames;
+        }
+    }
+
+    std::cout << "Save state size: " << state.size() << " bytes\n"
+        "Save: " << saveSeconds * 1e6 / trials << " microseconds, load: " << loadSeconds * 1e6 /
+        trials << " microseconds\n";
+    if (mismatchedFrames == 0) {
+        std::cout << "All " << frames << " frames after loading the state match\n";
+    } else {
+        std::cout << mismatchedFrames << " of " << frames <<
+            " frames after loading the state don't match\n";
+        exit(1);
+    }
+}
+
+// Measures how big the rewind buffer gets and how long it takes to push a frame into it, and checks
+// that rewinding brings back every frame exactly. The .NES file is run for N frames (3600, which
+// is a minute, by default) with every frame pushed into a buffer that holds all of them. The
+// buffer is then rewound a frame at a time, where each frame has to save the same state that it
+// did when it was pushed. Lastly, the buffer is rewound by half of the frames at once, and those
+// frames are run again, where each frame and the RAM after it have to come out the same.
+// The argument after "rewindbench" is frames=N
+
+void runRewindBenchmark(NESCore& core, const std::string& filename, int argc, char* argv[]) {
+    unsigned int frames = 3600;
+    OptionParser parser("rewind benchmark", argc, argv, 3);
+    while (parser.next()) {
+        if (parser.getKey() != "frames") {
+            parser.reject();
+        }
+        frames = parser.getNumber(10, UINT_MAX);
+    }
+    if (frames < 2) {
+        std::cerr << "Rewind benchmark needs at least 2 frames\n";
+        exit(1);
+    }
+    core.load(readInROM(filename));
+    const unsigned int keyframeInterval = 60;
+    RewindBuffer rewindBuffer(frames, keyframeInterval);
+
+    // The hashes are only for checking, so they're taken outside of the timed parts
+    std::vector<uint32_t> stateHashes;
+    std::vector<uint32_t> outputHashes;
+    std::vector<uint8_t> state;
+    std::chrono::steady_clock::duration frameTime(0);
+    std::chrono::steady_clock::duration pushTime(0);
+    for (unsigned int i = 0; i < frames; ++i) {
+        const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+        core.runFrame();
+        const std::chrono::steady_clock::time_point pushStart = std::chrono::steady_clock::now();
+        rewindBuffer.push(core);
+        const std::chrono::steady_clock::time_point pushFinish = std::chrono::steady_clock::now();
+        frameTime += pushStart - frameStart;
+        pushTime += pushFinish - pushStart;
+        core.saveState(state);
+        stateHashes.push_back(hashBytes(state.data(), state.size(), hashStart));
+        outputHashes.push_back(core.hashOutput());
+    }
+    const size_t memoryUsage = rewindBuffer.getMemoryUsage();
+    const unsigned int keyframes = rewindBuffer.getKeyframeCount();
+
+    unsigned int mismatchedStates = 0;
+    std::chrono::steady_clock::duration rewindTime(0);
+    for (unsigned int i = frames - 1; i > 0; --i) {
+        const std::chrono::steady_clock::time_point rewindStart = std::chrono::steady_clock::now();
+        const bool rewound = rewindBuffer.rewind(core, 1);
+        rewindTime += std::chrono::steady_clock::now() - rewindStart;
+        core.saveState(state);
+        if (!rewound || hashBytes(state.data(), state.size(), hashStart) != stateHashes[i - 1]) {
+            ++mismatchedStates;
+        }
+    }
+
+    // Refill the buffer with the original frames and jump back by half of them
+    for (unsigned int i = 1; i < frames; ++i) {
+        core.runFrame();
+        rewindBuffer.push(core);
+    }
+    const unsigned int jumpFrames = frames / 2;
+    if (!rewindBuffer.rewind(core, jumpFrames)) {
+        std::cerr << "Could not rewind " << jumpFrames << " frames\n";
+        exit(1);
+    }
+    unsigned int mismatchedFrames = 0;
+    for (unsigned int i = frames - jumpFrames; i < frames; ++i) {
+        core.runFrame();
+        if (core.hashOutput() != outputHashes[i]) {
+            ++mismatchedFrames;
+        }
+    }
+
+    const double frameMicroseconds = std::chrono::duration_cast<std::chrono::duration<double>>(
+        frameTime).count() * 1e6 / frames;
+    const double pushMicroseconds = std::chrono::duration_cast<std::chrono::duration<double>>(
+        pushTime).count() * 1e6 / frames;
+    const double rewindMicroseconds = std::chrono::duration_cast<std::chrono::duration<double>>(
+        rewindTime).count() * 1e6 / (frames - 1);
+    std::cout << frames << " frames (" << keyframes << " keyframes) in " << memoryUsage <<
+        " bytes, " << memoryUsage / frames << " bytes per frame\n"
+        "Push: " << pushMicroseconds << " microseconds per frame (" << pushMicroseconds * 100 /
+        frameMicroseconds << "% of the " << frameMicroseconds << " microseconds that a frame takes "
+        "to run)\nRewind: " << rewindMicroseconds << " microseconds per frame\n";
+    if (mismatchedStates == 0 && mismatchedFrames == 0) {
+        std::cout << "All rewound states and frames match\n";
+    } else {
+        std::cout << mismatchedStates << " of " << frames - 1 << " rewound states and " <<
+            mismatchedFrames << " of " << jumpFrames << " frames after rewinding don't match\n";
+        exit(1);
+    }
+}
+
+// Reads from the RAM or the cartridge without side effects. Used for checking test results
+
+uint8_t readMemory(const CPU& cpu, const uint16_t addr) {
+    if (addr < 0x2000) {
+        return cpu.readRAM(addr);
+    } else if (addr >= 0x4020) {
+        return cpu.readPRG(addr);
+    }
+    std::cerr << "Address 0x" << std::hex << addr << std::dec << " is not in the RAM or "
+        "cartridge\n";
+    exit(1);
+}
+
+// Applies an option that configures the machine as a whole. runahead=K runs K frames ahead of the
+// frame that's displayed to hide K frames of input lag in the game and headless modes, and
+// runahead=0 turns it off (the default). Returns false if the argument isn't a machine option
+
+bool readInCoreOption(NESCore& core, const std::string& arg) {
+    const std::string runAheadKey = "runahead=";
+    unsigned int frames = 0;
+    if (arg.compare(0, runAheadKey.size(), runAheadKey) == 0 &&
+            OptionParser::parseNumber(arg.substr(runAheadKey.size()), 10, UINT_MAX, frames)) {
+        core.setRunAhead(frames);
+        return true;
+    }
+    return false;
+}
+
+void addFrameTime(struct FrameTimes& times, const std::chrono::steady_clock::duration time) {
+    const double microseconds = std::chrono::duration_cast<std::chrono::duration<double,
+        std::micro>>(time).count();
+    ++times.frames;
+    times.totalMicroseconds += microseconds;
+    times.maxMicroseconds = std::max(times.maxMicroseconds, microseconds);
+}
+
+// Prints how long each displayed frame took to emulate if run-ahead is on
+
+void printRunAheadStats(const NESCore& core, const struct FrameTimes& times) {
+    if (core.getRunAhead() == 0 || times.frames == 0) {
+        return;
+    }
+    const double meanMicroseconds = times.totalMicroseconds / times.frames;
+    std::cout << "Run-ahead: " << core.getRunAhead() << " frames, mean " << meanMicroseconds <<
+        " us per displayed frame (" << meanMicroseconds / (core.getRunAhead() + 1) <<
+        " us per emulated frame), max " << times.maxMicroseconds << " us\n";
+}
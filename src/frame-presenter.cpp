@@ -0,0 +1,129 @@
+#include "frame-presenter.h"
+
+// Public Member Functions
+
+FramePresenter::FramePresenter(SDL_Window* window) :
+        window(window),
+        renderer(nullptr),
+        textures(),
+        pixels(),
+        pitches(),
+        backIndex(0),
+        frontIndex(1),
+        slot(2),
+        isVsync(false),
+        hasFrame(false),
+        submittedFrames(0),
+        droppedFrames(0),
+        presentedFrames(0),
+        duplicatedFrames(0) { }
+
+// Creates the renderer and the textures, and locks every buffer except the front buffer so that
+// the back buffer can be converted into. Has to be called before the emulation thread starts
+
+void FramePresenter::start() {
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED |
+        SDL_RENDERER_PRESENTVSYNC);
+    if (renderer == nullptr) {
+        std::cerr << "Could not create renderer\n" << SDL_GetError();
+        exit(1);
+    }
+    for (unsigned int i = 0; i < bufferCount; ++i) {
+        textures[i] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_STREAMING, frameWidth, frameHeight);
+        if (textures[i] == nullptr) {
+            std::cerr << "Could not create texture\n" << SDL_GetError();
+            exit(1);
+        }
+        if (i != frontIndex) {
+            lockBuffer(i);
+        }
+    }
+    SDL_RendererInfo info;
+    SDL_GetRendererInfo(renderer, &info);
+    isVsync = info.flags & SDL_RENDERER_PRESENTVSYNC;
+}
+
+// Displays the newest frame that the emulation thread submitted. If the renderer waits for vsync,
+// this blocks until the next vsync and repeats the previous frame if no new one is ready.
+// Otherwise, it only displays new frames and sleeps for a millisecond when there isn't one, so that
+// the main thread can go back to polling events without spinning
+
+void FramePresenter::presentFrame() {
+    uint8_t currentSlot = slot.load(std::memory_order_acquire);
+    if (currentSlot & NewFrame) {
+        // The front buffer is locked again before it's handed off since the emulation thread
+        // can't lock textures itself
+        lockBuffer(frontIndex);
+        currentSlot = slot.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = currentSlot & BufferIndexMask;
+        // Unlocking the texture uploads the frame
+        SDL_UnlockTexture(textures[frontIndex]);
+        hasFrame = true;
+        ++presentedFrames;
+    } else if (isVsync && hasFrame) {
+        ++duplicatedFrames;
+    } else {
+        SDL_Delay(1);
+        return;
+    }
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, textures[frontIndex], nullptr, nullptr);
+    SDL_RenderPresent(renderer);
+}
+
+// Destroys the textures and the renderer. The emulation thread has to have stopped, since the back
+// buffer is in one of the textures
+
+void FramePresenter::stop() {
+    if (renderer == nullptr) {
+        return;
+    }
+    for (SDL_Texture* texture : textures) {
+        SDL_DestroyTexture(texture);
+    }
+    SDL_DestroyRenderer(renderer);
+    renderer = nullptr;
+}
+
+// Returns the locked texture memory that the next frame should be converted into. It isn't read by
+// the main thread until the frame is submitted
+
+uint32_t* FramePresenter::getBackBuffer() {
+    return pixels[backIndex];
+}
+
+unsigned int FramePresenter::getBackBufferPitch() const {
+    return pitches[backIndex];
+}
+
+// Hands the back buffer off to the main thread and takes whichever buffer was in the slot as the
+// new back buffer. If that buffer held a frame that the main thread never took, the frame is
+// dropped
+
+void FramePresenter::submitFrame() {
+    const uint8_t previousSlot = slot.exchange(backIndex | NewFrame, std::memory_order_acq_rel);
+    if (previousSlot & NewFrame) {
+        ++droppedFrames;
+    }
+    backIndex = previousSlot & BufferIndexMask;
+    ++submittedFrames;
+}
+
+void FramePresenter::printStats() const {
+    std::cout << "Presented frames: " << presentedFrames << " of " << submittedFrames << " (" <<
+        droppedFrames << " dropped, " << duplicatedFrames << " duplicated)\n";
+}
+
+// Private Member Functions
+
+// Locks the texture of the given buffer so that a frame can be converted into its memory
+
+void FramePresenter::lockBuffer(const unsigned int index) {
+    void* lockedPixels = nullptr;
+    if (SDL_LockTexture(textures[index], nullptr, &lockedPixels, &pitches[index]) != 0) {
+        std::cerr << "Could not lock texture\n" << SDL_GetError();
+        exit(1);
+    }
+    pixels[index] = (uint32_t*) lockedPixels;
+}
@@ -0,0 +1,88 @@
+#ifndef FRAMEPRESENTER_H
+#define FRAMEPRESENTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <SDL.h>
+
+// Frame Presenter
+// Displays the frames that the emulation finishes on another thread, so that a slow or
+// vsync-blocked present never stalls the emulation. Everything that touches the renderer runs on
+// the main thread, which is the thread that created the window and polls its events, since SDL
+// doesn't support rendering from any other thread on some platforms (e.g., macOS). The emulation
+// runs on a thread of its own instead. Frames are triple buffered: the emulation thread converts
+// each frame into the back buffer, the main thread displays the front buffer, and the third buffer
+// holds the newest finished frame. The two threads hand buffers off through a lock-free
+// single-producer/single-consumer slot, so neither of them ever waits for the other. Each buffer is
+// a streaming texture that stays locked while the emulation thread owns it, so frames are
+// converted straight into the texture's memory without being copied
+
+class FramePresenter {
+    public:
+        FramePresenter(SDL_Window* window);
+
+        // Main Thread
+        void start();
+        void presentFrame();
+        void stop();
+
+        // Emulation Thread
+        uint32_t* getBackBuffer();
+        unsigned int getBackBufferPitch() const;
+        void submitFrame();
+
+        void printStats() const;
+
+    private:
+        // The back, ready, and front buffers
+        static const unsigned int bufferCount = 3;
+        static const unsigned int frameWidth = 256;
+        static const unsigned int frameHeight = 240;
+
+        // Bits of the slot
+        enum SlotBits {
+            // Index of the buffer that's in the slot
+            BufferIndexMask = 3,
+            // Set if the buffer in the slot holds a frame that the presenter hasn't taken yet
+            NewFrame = 4
+        };
+
+        SDL_Window* window;
+        SDL_Renderer* renderer;
+        // Streaming texture of each buffer. Every texture except the front buffer's is locked
+        SDL_Texture* textures[bufferCount];
+        // Locked memory of each texture and the number of bytes between the start of its rows. Set
+        // by the main thread before the buffer is handed off to the emulation thread
+        uint32_t* pixels[bufferCount];
+        int pitches[bufferCount];
+        // Index of the buffer that the emulation thread converts the next frame into. Only used by
+        // the emulation thread
+        unsigned int backIndex;
+        // Index of the buffer that's displayed. Only used by the main thread
+        unsigned int frontIndex;
+        // Buffer that is handed from one thread to the other. The emulation thread swaps the back
+        // buffer in after finishing a frame, and the main thread swaps the front buffer in to take
+        // the newest frame. Depends on enum SlotBits
+        std::atomic<uint8_t> slot;
+        // Set to true if the renderer waits for vsync
+        bool isVsync;
+        // Set to true once the front buffer holds a frame
+        bool hasFrame;
+
+        // Statistics
+
+        // Number of frames that the emulation thread finished
+        unsigned int submittedFrames;
+        // Number of finished frames that were replaced by a newer frame before they were displayed
+        unsigned int droppedFrames;
+        // Number of new frames that were displayed
+        unsigned int presentedFrames;
+        // Number of times that the previous frame was displayed again because no new frame was
+        // finished by the next vsync. Only counted if the renderer waits for vsync
+        unsigned int duplicatedFrames;
+
+        void lockBuffer(const unsigned int index);
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "frame-scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Public Member Functions
+
+FrameScheduler::FrameScheduler(const double frameRate) :
+        frameRate(frameRate),
+        startTime(Clock::now()),
+        frameNum(0),
+        totalFrames(0),
+        lateFrames(0),
+        resyncs(0),
+        overshootSum(0),
+        overshootSquaredSum(0),
+        maxOvershoot(0) { }
+
+// Sets the first deadline to one frame period from now
+
+void FrameScheduler::start() {
+    startTime = Clock::now();
+    frameNum = 0;
+}
+
+// Blocks until the deadline of the current frame, then moves on to the next frame's deadline
+
+void FrameScheduler::waitForNextFrame() {
+    ++frameNum;
+    const Clock::time_point deadline = getDeadline(frameNum);
+    Clock::time_point now = Clock::now();
+    ++totalFrames;
+
+    if (now >= deadline) {
+        ++lateFrames;
+        // If the emulator is more than a frame behind, start over from the current time instead of
+        // running frames back to back to catch up
+        if (now - deadline > getDeadline(1) - startTime) {
+            ++resyncs;
+            start();
+        }
+        return;
+    }
+
+    // Sleeping usually overshoots by tens of microseconds, so wake up early and spin for the rest
+    const std::chrono::microseconds spinTime(500);
+    if (deadline - now > spinTime) {
+        std::this_thread::sleep_for(deadline - now - spinTime);
+    }
+    now = Clock::now();
+    while (now < deadline) {
+        std::this_thread::yield();
+        now = Clock::now();
+    }
+
+    const double overshoot = std::chrono::duration_cast<std::chrono::duration<double,
+        std::micro>>(now - deadline).count();
+    overshootSum += overshoot;
+    overshootSquaredSum += overshoot * overshoot;
+    if (overshoot > maxOvershoot) {
+        maxOvershoot = overshoot;
+    }
+}
+
+// Prints how accurately the frames were paced. Jitter is the standard deviation of the overshoot
+
+void FrameScheduler::printStats() const {
+    const unsigned int onTimeFrames = totalFrames - lateFrames;
+    double meanOvershoot = 0;
+    double jitter = 0;
+    if (onTimeFrames > 0) {
+        meanOvershoot = overshootSum / onTimeFrames;
+        jitter = std::sqrt(std::max(0.0, overshootSquaredSum / onTimeFrames - meanOvershoot *
+            meanOvershoot));
+    }
+    std::cout << "Frames: " << totalFrames << " (" << lateFrames << " late, " << resyncs <<
+        " resyncs)\nOvershoot: mean " << meanOvershoot << " us, max " << maxOvershoot <<
+        " us, jitter " << jitter << " us\n";
+}
+
+// Private Member Functions
+
+// Calculates the deadline of the given frame from the start time rather than from the previous
+// deadline, so that the error doesn't accumulate from frame to frame
+
+FrameScheduler::Clock::time_point FrameScheduler::getDeadline(const unsigned int frame) const {
+    const std::chrono::duration<double> elapsed(frame / frameRate);
+    return startTime + std::chrono::duration_cast<Clock::duration>(elapsed);
+}
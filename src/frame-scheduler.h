@@ -0,0 +1,54 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// Frame Scheduler
+// Paces the emulator to the frame rate of the console. Each frame has an absolute deadline that is
+// derived from the number of frames since the scheduler started, so rounding errors and late
+// frames don't accumulate into drift. The scheduler sleeps for most of the time until the deadline
+// and only spins for the last fraction of a millisecond, which keeps the host CPU mostly idle
+
+class FrameScheduler {
+    public:
+        FrameScheduler(const double frameRate);
+        void start();
+        void waitForNextFrame();
+        void printStats() const;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        // Number of frames per second to schedule
+        double frameRate;
+        // Time that the deadlines are measured from. Reset whenever the emulator falls too far
+        // behind to catch up
+        Clock::time_point startTime;
+        // Number of frames since startTime
+        unsigned int frameNum;
+
+        // Statistics
+
+        // Total number of frames that have been waited for
+        unsigned int totalFrames;
+        // Number of waits that started at or after their deadline, so there was nothing left to wait
+        // for. It counts everything that the caller did since the last wait (e.g., rewinding and
+        // pushing into the rewind buffer as well as emulating), not just the emulation. A frame
+        // that runs long can also make the frames after it late until the schedule catches up or
+        // is reset
+        unsigned int lateFrames;
+        // Number of times that the deadlines were reset because the emulator fell behind by more
+        // than a frame
+        unsigned int resyncs;
+        // Sum, sum of squares, and max of how long after the deadline the wait actually ended (in
+        // microseconds). Used for the mean overshoot and jitter
+        double overshootSum;
+        double overshootSquaredSum;
+        double maxOvershoot;
+
+        Clock::time_point getDeadline(const unsigned int frame) const;
+};
+
+#endif
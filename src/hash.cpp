@@ -0,0 +1,13 @@
+#include "hash.h"
+
+// Continues the hash over size bytes of data
+
+uint32_t hashBytes(const void* data, const size_t size, const uint32_t hash) {
+    const uint32_t prime = 16777619u;
+    const uint8_t* bytes = (const uint8_t*) data;
+    uint32_t result = hash;
+    for (size_t i = 0; i < size; ++i) {
+        result = (result ^ bytes[i]) * prime;
+    }
+    return result;
+}
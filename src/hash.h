@@ -0,0 +1,17 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Hash
+// FNV-1a hash (http://www.isthe.com/chongo/tech/comp/fnv/), which the benchmarks and tools use to
+// check that two runs came out the same without keeping everything that they output. Pieces of
+// memory can be hashed one after another by passing the hash so far into the next call, starting
+// with hashStart
+
+const uint32_t hashStart = 2166136261u;
+
+uint32_t hashBytes(const void* data, const size_t size, const uint32_t hash);
+
+#endif
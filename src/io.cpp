@@ -3,31 +3,17 @@
 // Public Member Functions
 
 IO::IO() :
-        strobe(false),
-        currentButton(A),
-        a(0),
-        b(0),
-        select(0),
-        start(0),
-        up(0),
-        down(0),
-        left(0),
-        right(0) {
+        strobe(false) {
     memset(registers, 0, 2);
+    memset(currentButtons, 0, sizeof(currentButtons));
+    memset(buttons, 0, 2);
 }
 
 void IO::clear() {
     memset(registers, 0, 2);
     strobe = false;
-    currentButton = A;
-    a = 0;
-    b = 0;
-    select = 0;
-    start = 0;
-    up = 0;
-    down = 0;
-    left = 0;
-    right = 0;
+    memset(currentButtons, 0, sizeof(currentButtons));
+    memset(buttons, 0, 2);
 }
 
 // Handles register reads from the CPU
@@ -35,47 +21,23 @@ void IO::clear() {
 uint8_t IO::readRegister(const uint16_t addr) {
     const uint16_t localAddr = getLocalAddr(addr);
     const uint8_t primaryControllerStatus = 1;
+    if (localAddr == 1) {
+        registers[localAddr] = 0;
+    }
+    // Clear the primary controller status bit
+    registers[localAddr] &= ~primaryControllerStatus;
     // If strobe mode is on, only return the status of the A button
-    if (localAddr == 0 && strobe) {
-        // Clear the primary controller status bit
-        registers[localAddr] &= ~primaryControllerStatus;
-        registers[localAddr] |= a;
+    if (strobe) {
+        registers[localAddr] |= buttons[localAddr] & ButtonA;
     // If strobe mode is off, cycle through each button on each CPU read
-    } else if (localAddr == 0 && !strobe) {
-        // Clear the primary controller status bit
-        registers[localAddr] &= ~primaryControllerStatus;
-        switch (currentButton) {
-            case A:
-                registers[localAddr] |= a;
-                break;
-            case B:
-                registers[localAddr] |= b;
-                break;
-            case Select:
-                registers[localAddr] |= select;
-                break;
-            case Start:
-                registers[localAddr] |= start;
-                break;
-            case Up:
-                registers[localAddr] |= up;
-                break;
-            case Down:
-                registers[localAddr] |= down;
-                break;
-            case Left:
-                registers[localAddr] |= left;
-                break;
-            case Right:
-                registers[localAddr] |= right;
-        }
-        ++currentButton;
+    } else {
+        registers[localAddr] |= (buttons[localAddr] >> currentButtons[localAddr]) & 1;
+        ++currentButtons[localAddr];
+        const unsigned int buttonCount = 8;
         // Wraparound back to the A button
-        if (currentButton > Right) {
-            currentButton = A;
+        if (currentButtons[localAddr] == buttonCount) {
+            currentButtons[localAddr] = 0;
         }
-    } else if (localAddr == 1) {
-        registers[localAddr] = 0;
     }
     // This bit is always set on the bus
     registers[localAddr] |= 0x40;
@@ -92,49 +54,38 @@ void IO::writeRegister(const uint16_t addr, const uint8_t val) {
         if (val & 1) {
             strobe = true;
             // Reset to the A button whenever strobe mode is set
-            currentButton = A;
+            memset(currentButtons, 0, sizeof(currentButtons));
         } else {
             strobe = false;
         }
     }
 }
 
-// Whenever the runNESGame function in emulator.cpp receives a key press or release, this function
-// gets called. This function sets the first bit of the specified button, which later gets ORed with
-// joystick register to signify a button press
+// Sets which buttons are held on the joystick in the given port (0 for joystick 1 and 1 for
+// joystick 2). Each set bit of the mask is a held button, which depends on enum Button
 
-void IO::updateButton(const SDL_Event& event) {
-    uint8_t pressed = 0;
-    if (event.type == SDL_KEYDOWN) {
-        pressed = 1;
-    }
-    switch (event.key.keysym.sym) {
-        case SDLK_x:
-            a = pressed;
-            break;
-        case SDLK_z:
-            b = pressed;
-            break;
-        case SDLK_UP:
-            up = pressed;
-            break;
-        case SDLK_DOWN:
-            down = pressed;
-            break;
-        case SDLK_LEFT:
-            left = pressed;
-            break;
-        case SDLK_RIGHT:
-            right = pressed;
-            break;
-        case SDLK_RETURN:
-            start = pressed;
-            break;
-        case SDLK_RSHIFT:
-            select = pressed;
+void IO::setButtons(const unsigned int port, const uint8_t mask) {
+    if (port < 2) {
+        buttons[port] = mask;
     }
 }
 
+// The held buttons are saved too, but they're usually set again before the next frame anyway
+
+void IO::saveState(StateWriter& writer) const {
+    writer.write(registers);
+    writer.write(strobe);
+    writer.write(currentButtons);
+    writer.write(buttons);
+}
+
+void IO::loadState(StateReader& reader) {
+    reader.read(registers);
+    reader.read(strobe);
+    reader.read(currentButtons);
+    reader.read(buttons);
+}
+
 // Private Member Functions
 
 // Maps the CPU address to the I/O local field, registers
@@ -4,7 +4,8 @@
 #include <cstdint>
 #include <cstring>
 #include <iostream>
-#include <SDL.h>
+
+#include "save-state.h"
 
 // Input/Output (Joysticks)
 // Handles anything related to I/O from the user. Stores data for addresses $4016 (joystick 1) and
@@ -16,7 +17,22 @@ class IO {
         void clear();
         uint8_t readRegister(const uint16_t addr);
         void writeRegister(const uint16_t addr, const uint8_t val);
-        void updateButton(const SDL_Event& event);
+        void setButtons(const unsigned int port, const uint8_t mask);
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
+
+        // Joystick buttons
+        // Bits of a button mask, in the order that the joystick reports the buttons in
+        enum Button {
+            ButtonA = 1,
+            ButtonB = 2,
+            ButtonSelect = 4,
+            ButtonStart = 8,
+            ButtonUp = 0x10,
+            ButtonDown = 0x20,
+            ButtonLeft = 0x40,
+            ButtonRight = 0x80
+        };
 
     private:
         // I/O registers in the CPU memory map, including joystick 1 and joystick 2
@@ -24,37 +40,15 @@ class IO {
         // Strobe mode. If strobe mode is set, only the status of the A button is set to the
         // joystick register. Otherwise, it cycles through each button on each CPU read
         bool strobe;
-        // The current button to return the status of when strobe mode is off. Depends on enum
-        // ButtonPress
-        unsigned int currentButton;
-
-        // Joystick buttons
-        // Only the first bit of each field is used. These fields are ORed with the joystick
-        // register to signify a button press
-
-        uint8_t a;
-        uint8_t b;
-        uint8_t select;
-        uint8_t start;
-        uint8_t up;
-        uint8_t down;
-        uint8_t left;
-        uint8_t right;
+        // The current button of each joystick to return the status of when strobe mode is off.
+        // It's the bit number of the button in enum Button
+        unsigned int currentButtons[2];
+        // Buttons that are held on each joystick. Depends on enum Button
+        uint8_t buttons[2];
 
         uint16_t getLocalAddr(const uint16_t addr) const;
 
         friend class CPU;
-
-        enum ButtonPress {
-            A = 0,
-            B = 1,
-            Select = 2,
-            Start = 3,
-            Up = 4,
-            Down = 5,
-            Left = 6,
-            Right = 7
-        };
 };
 
 #endif
\ No newline at end of file
@@ -3,10 +3,12 @@
 // Public Member Functions
 
 MMC::MMC() :
-        prgROM(0x4000 * 2, 0),
-        chrMemory(0x1000 * 2, 0),
+        prgROM(nullptr),
+        prgROMBytes(0),
+        chrMemory(nullptr),
+        chrMemoryBytes(0),
         prgROMSize(2),
-        chrMemorySize(2),
+        chrMemorySize(1),
         mirroring(0),
         mapperID(0),
         shiftRegister(0x10),
@@ -17,26 +19,14 @@ MMC::MMC() :
         chrBank1(0),
         chrRAM(false),
         lastWriteCycle(0),
-        testMode(false) { }
+        testMode(false) {
+    loadImage(ROMImage::getBlankImage());
+}
 
 void MMC::clear() {
     const uint16_t prgROMStart = 0x8000;
     const uint16_t ioRegisterEnd = 0x4020;
     memset(prgRAM, 0, prgROMStart - ioRegisterEnd);
-    const uint16_t defaultPRGBankSize = 0x4000;
-    prgROM.resize(defaultPRGBankSize * 2);
-    for (uint8_t& entry : prgROM) {
-        entry = 0;
-    }
-    const uint16_t defaultCHRBankSize = 0x1000;
-    chrMemory.resize(defaultCHRBankSize * 2);
-    for (uint8_t& entry : chrMemory) {
-        entry = 0;
-    }
-    prgROMSize = 2;
-    chrMemorySize = 2;
-    mirroring = 0;
-    mapperID = 0;
     shiftRegister = 0x10;
     prgBankMode = 0;
     chrBankMode = 0;
@@ -46,37 +36,79 @@ void MMC::clear() {
     chrRAM = false;
     lastWriteCycle = 0;
     testMode = false;
+    loadImage(ROMImage::getBlankImage());
+}
+
+// Copies another MMC. The PRG-ROM, CHR memory, and slots are pointed into this MMC's own copies of
+// the other MMC's memory instead of the other MMC's
+
+MMC::MMC(const MMC& other) {
+    *this = other;
+}
+
+MMC& MMC::operator=(const MMC& other) {
+    if (this == &other) {
+        return *this;
+    }
+    memcpy(prgRAM, other.prgRAM, sizeof(prgRAM));
+    rom = other.rom;
+    prgROMBytes = other.prgROMBytes;
+    chrMemoryBytes = other.chrMemoryBytes;
+    ownPRGROM = other.ownPRGROM;
+    ownCHRMemory = other.ownCHRMemory;
+    prgROMSize = other.prgROMSize;
+    chrMemorySize = other.chrMemorySize;
+    mirroring = other.mirroring;
+    mapperID = other.mapperID;
+    shiftRegister = other.shiftRegister;
+    prgBankMode = other.prgBankMode;
+    chrBankMode = other.chrBankMode;
+    prgBank = other.prgBank;
+    chrBank0 = other.chrBank0;
+    chrBank1 = other.chrBank1;
+    chrRAM = other.chrRAM;
+    lastWriteCycle = other.lastWriteCycle;
+    testMode = other.testMode;
+    updateMemoryPointers();
+    return *this;
 }
 
 // Handles reads from the CPU
 
 uint8_t MMC::readPRG(const uint16_t addr) const {
-    const unsigned int localAddr = getLocalPRGAddr(addr);
     const uint16_t prgROMStart = 0x8000;
     // PRG-RAM is in $4020 - $7fff, while PRG-ROM is in $8000 - $ffff
     if (addr < prgROMStart) {
-        return prgRAM[localAddr];
+        return prgRAM[getLocalPRGAddr(addr)];
     }
-    return prgROM[localAddr];
+    const uint16_t prgSlotSize = 0x1000;
+    return prgSlots[(addr - prgROMStart) / prgSlotSize][addr % prgSlotSize];
 }
 
-// Handles writes from the CPU
+// Handles writes from the CPU. Returns true if the write changed which PRG banks are swapped in
 
-void MMC::writePRG(const uint16_t addr, const uint8_t val, const unsigned int totalCycles) {
-    const unsigned int localAddr = getLocalPRGAddr(addr);
+bool MMC::writePRG(const uint16_t addr, const uint8_t val, const unsigned int totalCycles) {
     const uint16_t prgROMStart = 0x8000;
     // PRG-RAM is in $4020 - $7fff, while PRG-ROM is in $8000 - $ffff
     if (addr < prgROMStart) {
-        prgRAM[localAddr] = val;
-        return;
+        prgRAM[getLocalPRGAddr(addr)] = val;
+        return false;
     }
-    // If test mode is enabled, allow writes to PRG-ROM
+    // If test mode is enabled, allow writes to PRG-ROM. The first write copies it so that the
+    // shared ROM image stays the same, which moves all of the PRG slots
     if (testMode) {
-        prgROM[localAddr] = val;
+        const bool copied = copyPRGROM();
+        const uint16_t prgSlotSize = 0x1000;
+        const size_t localAddr = prgSlots[(addr - prgROMStart) / prgSlotSize] - prgROM +
+            addr % prgSlotSize;
+        ownPRGROM[localAddr] = val;
         // Return early because test mode assumes 2 fixed PRG banks and no mapper
-        return;
+        return copied;
     }
 
+    const unsigned int pastPRGBank = prgBank;
+    const unsigned int pastPRGBankMode = prgBankMode;
+
     // Writes to the PRG-ROM are used by the CPU to control the MMC, and the mapper ID (i.e., the
     // type of MMC) determines how to intrepret the writes
     switch (mapperID) {
@@ -91,7 +123,8 @@ void MMC::writePRG(const uint16_t addr, const uint8_t val, const unsigned int to
         case 3:
             // Mapper 3: https://www.nesdev.org/wiki/INES_Mapper_003#Registers
             chrBank0 = val & 3;
-            expandCHRMemory(chrBank0);
+            expandCHRMemory();
+            updateCHRSlots();
             break;
         case 7:
             // Mapper 7: https://www.nesdev.org/wiki/AxROM#Registers
@@ -102,22 +135,63 @@ void MMC::writePRG(const uint16_t addr, const uint8_t val, const unsigned int to
                 mirroring = SingleScreen0;
             }
     }
+    if (prgBank == pastPRGBank && prgBankMode == pastPRGBankMode) {
+        return false;
+    }
+    updatePRGSlots();
+    return true;
+}
+
+// Returns a pointer to where the 256-byte page of the CPU memory map with the given page number
+// (i.e., the high byte of the address) is stored, so that the CPU can read from it directly. PRG
+// slots are multiples of the page size, so each page is stored contiguously. Returns nullptr if the
+// page isn't entirely in PRG-RAM or PRG-ROM
+
+const uint8_t* MMC::getPRGPage(const uint8_t page) const {
+    const uint16_t addr = page << 8;
+    const uint16_t prgRAMStart = 0x4020;
+    if (addr < prgRAMStart) {
+        return nullptr;
+    }
+    const uint16_t prgROMStart = 0x8000;
+    if (addr < prgROMStart) {
+        return prgRAM + getLocalPRGAddr(addr);
+    }
+    const uint16_t prgSlotSize = 0x1000;
+    return prgSlots[(addr - prgROMStart) / prgSlotSize] + addr % prgSlotSize;
+}
+
+// Returns a pointer to where the 256-byte page of the CPU memory map with the given page number is
+// stored, so that the CPU can write to it directly. Returns nullptr if the page isn't entirely in
+// PRG-RAM since PRG-ROM can't be written to
+
+uint8_t* MMC::getPRGRAMPage(const uint8_t page) {
+    const uint16_t addr = page << 8;
+    const uint16_t prgRAMStart = 0x4020;
+    const uint16_t prgROMStart = 0x8000;
+    if (addr < prgRAMStart || addr >= prgROMStart) {
+        return nullptr;
+    }
+    return prgRAM + getLocalPRGAddr(addr);
 }
 
 // Handles reads from the PPU
 
 uint8_t MMC::readCHR(const uint16_t addr) const {
-    const unsigned int localAddr = getLocalCHRAddr(addr);
-    return chrMemory[localAddr];
+    const uint16_t chrSlotSize = 0x400;
+    return chrSlots[addr / chrSlotSize][addr % chrSlotSize];
 }
 
 // Handles writes from the PPU
 
 void MMC::writeCHR(const uint16_t addr, const uint8_t val) {
-    const unsigned int localAddr = getLocalCHRAddr(addr);
-    // If CHR-RAM or test mode is enabled, allow writes to CHR-ROM
+    // If CHR-RAM or test mode is enabled, allow writes to CHR-ROM. CHR-RAM is always this MMC's
+    // own, while CHR-ROM gets copied on the first write so that the shared ROM image stays the same
     if (chrRAM || testMode) {
-        chrMemory[localAddr] = val;
+        copyCHRMemory();
+        const uint16_t chrSlotSize = 0x400;
+        const size_t localAddr = chrSlots[addr / chrSlotSize] - chrMemory + addr % chrSlotSize;
+        ownCHRMemory[localAddr] = val;
     }
 }
 
@@ -132,6 +206,8 @@ void MMC::readInInst(const std::string& filename) {
         exit(1);
     }
 
+    // The instructions get written into this MMC's own copy of the PRG-ROM
+    copyPRGROM();
     unsigned int addr = 0;
     while (file.good()) {
         getline(file, line);
@@ -147,7 +223,7 @@ void MMC::readInInst(const std::string& filename) {
 
             // Every two characters in an instruction file represents a byte
             if (i % 2) {
-                prgROM[addr] = std::stoul(substring, nullptr, 16);
+                ownPRGROM[addr] = std::stoul(substring, nullptr, 16);
                 ++addr;
                 substring = "";
             }
@@ -160,78 +236,53 @@ void MMC::readInInst(const std::string& filename) {
     const uint16_t prgROMStart = 0x8000;
     // Set the reset vector to $8000, the beginning of the PRG-ROM lower bank. This is where test
     // programs will start at
-    prgROM[upperResetAddr - prgROMStart] = 0x80;
+    ownPRGROM[upperResetAddr - prgROMStart] = 0x80;
 }
 
-// Reads in an .NES file: https://www.nesdev.org/wiki/INES
-
-void MMC::readInINES(const std::string& filename) {
-    std::ifstream file(filename.c_str(), std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Error reading in file\n";
-        exit(1);
-    }
-
-    const uint8_t headerSize = 0x10;
-    uint8_t readInByte;
-    bool hasTrainer = false;
-    // Use any relevant info from the header
-    for (unsigned int i = 0; i < headerSize; ++i) {
-        file.read((char*) &readInByte, 1);
-        if (i == 4) {
-            const uint16_t defaultPRGBankSize = 0x4000;
-            prgROMSize = readInByte;
-            prgROM.resize(prgROMSize * defaultPRGBankSize);
-        } else if (i == 5) {
-            const uint16_t defaultCHRBankSize = 0x1000;
-            chrMemorySize = readInByte;
-            chrMemory.resize(chrMemorySize * defaultCHRBankSize * 2);
-        } else if (i == 6) {
-            if (readInByte & 1) {
-                mirroring = Vertical;
-            } else {
-                mirroring = Horizontal;
-            }
-            if (readInByte & 4) {
-                hasTrainer = true;
-            }
-            mapperID = (readInByte & 0xf0) >> 4;
-        } else if (i == 7) {
-            mapperID |= readInByte & 0xf0;
-        }
-    }
-
-    if (mapperID > 3 && mapperID != 7) {
-        std::cerr << "Only mappers 0, 1, 2, 3, and 7 are supported\n";
-        exit(1);
-    }
+// Loads an .NES file that has already been turned into a ROM image. Every MMC that loads the same
+// image reads the PRG-ROM and CHR-ROM out of it instead of keeping its own copy. Returns false
+// without changing the MMC if the image's mapper isn't supported
 
-    const uint16_t trainerSize = 0x200;
-    // Skip over trainer data if there is any
-    if (hasTrainer) {
-        for (unsigned int i = 0; i < trainerSize; ++i) {
-            file.read((char*) &readInByte, 1);
-        }
+bool MMC::loadImage(const std::shared_ptr<const ROMImage>& image) {
+    const struct ROMImage::Header& header = image->getHeader();
+    if (!isMapperSupported(header.mapperID)) {
+        return false;
     }
 
+    // Use any relevant info from the header. NES 2.0 sizes don't have to be multiples of the bank
+    // size, so partial banks count as a whole bank. They're still whole 4 KB PRG and 1 KB CHR slots
+    // (which ROMImage checks), and the slots wrap around within the ROM, so none of them run past
+    // its end
     const uint16_t defaultPRGBankSize = 0x4000;
-    // Read in PRG-ROM
-    for (unsigned int i = 0; i < prgROMSize * defaultPRGBankSize; ++i) {
-        file.read((char*) &prgROM[i], 1);
-    }
-
     const uint16_t defaultCHRBankSize = 0x1000;
-    // Read in CHR-ROM
-    for (unsigned int i = 0; i < chrMemorySize * defaultCHRBankSize * 2; ++i) {
-        file.read((char*) &chrMemory[i], 1);
+    prgROMSize = (header.prgROMBytes + defaultPRGBankSize - 1) / defaultPRGBankSize;
+    chrMemorySize = (header.chrROMBytes + defaultCHRBankSize * 2 - 1) / (defaultCHRBankSize * 2);
+    if (header.verticalMirroring) {
+        mirroring = Vertical;
+    } else {
+        mirroring = Horizontal;
     }
-
-    file.close();
-
-    // CHR memory size is unknown, so enable CHR-RAM and automatically resize to accomodate what the
-    // game uses
-    if (chrMemorySize == 0) {
-        chrRAM = true;
+    mapperID = header.mapperID;
+    rom = image;
+    prgROM = rom->getPRGROM();
+    prgROMBytes = header.prgROMBytes;
+    chrMemory = rom->getCHRROM();
+    chrMemoryBytes = header.chrROMBytes;
+    // Drop any copies of the last image
+    std::vector<uint8_t>().swap(ownPRGROM);
+    std::vector<uint8_t>().swap(ownCHRMemory);
+
+    // Enable CHR-RAM if there's no CHR-ROM. Start with as much as a NES 2.0 header asks for
+    // (rounded up to whole 1 KB slots), or else enough for both pattern tables, and automatically
+    // resize to accomodate what the game uses
+    chrRAM = chrMemorySize == 0;
+    if (chrRAM) {
+        const uint16_t chrSlotSize = 0x400;
+        const size_t requestedCHRRAMBytes = (header.chrRAMBytes + header.chrNVRAMBytes +
+            chrSlotSize - 1) / chrSlotSize * chrSlotSize;
+        ownCHRMemory.resize(std::max<size_t>(defaultCHRBankSize * 2, requestedCHRRAMBytes));
+        chrMemory = ownCHRMemory.data();
+        chrMemoryBytes = ownCHRMemory.size();
     }
 
     // Pretty much all mapper 1 games power on the last bank by default:
@@ -241,12 +292,104 @@ void MMC::readInINES(const std::string& filename) {
     if (mapperID == 1) {
         prgBankMode = 3;
     }
+    updatePRGSlots();
+    updateCHRSlots();
+    return true;
 }
 
 unsigned int MMC::getMirroring() const {
     return mirroring;
 }
 
+// Saves the banking state, PRG-RAM, and any memory that this MMC has of its own (i.e., CHR-RAM and
+// test mode copies). The PRG-ROM and CHR-ROM aren't saved since they're in the ROM image, so the
+// state can only be loaded into an MMC that has the same ROM loaded, which is checked using the
+// ROM's hash, the mapper ID, and whether it has CHR-RAM
+
+void MMC::saveState(StateWriter& writer) const {
+    writer.write(rom->getHash());
+    writer.write(mapperID);
+    writer.write(chrRAM);
+    writer.write(prgRAM);
+    writer.write(chrMemorySize);
+    writer.write(mirroring);
+    writer.write(shiftRegister);
+    writer.write(prgBankMode);
+    writer.write(chrBankMode);
+    writer.write(prgBank);
+    writer.write(chrBank0);
+    writer.write(chrBank1);
+    writer.write(lastWriteCycle);
+    writer.write(testMode);
+    const uint32_t ownPRGROMBytes = ownPRGROM.size();
+    writer.write(ownPRGROMBytes);
+    writer.write(ownPRGROM.data(), ownPRGROMBytes);
+    const uint32_t ownCHRMemoryBytes = ownCHRMemory.size();
+    writer.write(ownCHRMemoryBytes);
+    writer.write(ownCHRMemory.data(), ownCHRMemoryBytes);
+}
+
+// Returns false if the state is for a different ROM or too short, in which case the MMC has to be
+// restored by the caller since some of it could've been loaded already
+
+bool MMC::loadState(StateReader& reader) {
+    uint32_t savedHash = 0;
+    unsigned int savedMapperID = 0;
+    bool savedCHRRAM = false;
+    reader.read(savedHash);
+    reader.read(savedMapperID);
+    reader.read(savedCHRRAM);
+    if (reader.hasFailed() || savedHash != rom->getHash() || savedMapperID != mapperID ||
+            savedCHRRAM != chrRAM) {
+        return false;
+    }
+    reader.read(prgRAM);
+    reader.read(chrMemorySize);
+    reader.read(mirroring);
+    reader.read(shiftRegister);
+    reader.read(prgBankMode);
+    reader.read(chrBankMode);
+    reader.read(prgBank);
+    reader.read(chrBank0);
+    reader.read(chrBank1);
+    reader.read(lastWriteCycle);
+    reader.read(testMode);
+
+    // The sizes of the copies are checked against what's left of the state before they're
+    // allocated, since a damaged state could have any size there. The slots point into the
+    // copies, so a copy of the PRG-ROM or CHR-ROM has to be as big as the ROM, and CHR-RAM has to
+    // be a whole number of slots
+    uint32_t ownPRGROMBytes = 0;
+    reader.read(ownPRGROMBytes);
+    if (ownPRGROMBytes > reader.getRemainingSize() ||
+            (ownPRGROMBytes != 0 && ownPRGROMBytes != prgROMBytes)) {
+        return false;
+    }
+    ownPRGROM.resize(ownPRGROMBytes);
+    reader.read(ownPRGROM.data(), ownPRGROMBytes);
+    uint32_t ownCHRMemoryBytes = 0;
+    reader.read(ownCHRMemoryBytes);
+    if (ownCHRMemoryBytes > reader.getRemainingSize()) {
+        return false;
+    }
+    const uint16_t chrSlotSize = 0x400;
+    if (chrRAM && (ownCHRMemoryBytes == 0 || ownCHRMemoryBytes % chrSlotSize != 0)) {
+        return false;
+    }
+    if (!chrRAM && ownCHRMemoryBytes != 0 &&
+            ownCHRMemoryBytes != rom->getHeader().chrROMBytes) {
+        return false;
+    }
+    ownCHRMemory.resize(ownCHRMemoryBytes);
+    reader.read(ownCHRMemory.data(), ownCHRMemoryBytes);
+    updateMemoryPointers();
+    return !reader.hasFailed();
+}
+
+bool MMC::isMapperSupported(const unsigned int mapperID) {
+    return mapperID <= 3 || mapperID == 7;
+}
+
 // Private Member Functions
 
 // Maps the CPU address to the MMC's local fields, prgRAM and prgROM
@@ -443,23 +586,111 @@ void MMC::updateSettings(const uint16_t addr) {
         chrBankMode = (shiftRegister >> 4) & 1;
     } else if (addr < chrBank1Start) {
         chrBank0 = shiftRegister & 0x1f;
-        expandCHRMemory(chrBank0);
     } else if (addr < prgBankStart) {
         chrBank1 = shiftRegister & 0x1f;
-        expandCHRMemory(chrBank1);
     } else {
         prgBank = shiftRegister & 0xf;
     }
     // Reset shift register to its default value
     shiftRegister = 0x10;
+    // The CHR bank mode or one of the CHR banks may have changed. Changes to the PRG banks are
+    // handled by writePRG
+    expandCHRMemory();
+    updateCHRSlots();
 }
 
 // Increases the CHR memory size if CHR-RAM is enabled and the game selects a CHR bank that has not
 // yet been allocated
 
-void MMC::expandCHRMemory(const unsigned int selectedCHRBank) {
-    if (chrRAM && selectedCHRBank >= chrMemorySize) {
-        chrMemory.resize((selectedCHRBank + 1) * 2);
-        chrMemorySize = selectedCHRBank + 1;
+void MMC::expandCHRMemory() {
+    if (!chrRAM) {
+        return;
+    }
+    const unsigned int chrSlotCount = 8;
+    const uint16_t chrSlotSize = 0x400;
+    size_t size = chrMemoryBytes;
+    for (unsigned int i = 0; i < chrSlotCount; ++i) {
+        const unsigned int slotEnd = getLocalCHRAddr(i * chrSlotSize) + chrSlotSize;
+        if (slotEnd > size) {
+            size = slotEnd;
+        }
     }
-}
\ No newline at end of file
+    if (size > chrMemoryBytes) {
+        ownCHRMemory.resize(size);
+        chrMemory = ownCHRMemory.data();
+        chrMemoryBytes = size;
+        const uint16_t defaultCHRBankSize = 0x1000;
+        chrMemorySize = (size + defaultCHRBankSize * 2 - 1) / (defaultCHRBankSize * 2);
+    }
+}
+
+// Points each PRG slot to the PRG bank that is swapped into it. Banks past the end of the PRG-ROM
+// wrap around to the start, which is what happens with the unused upper bits of the bank number
+
+void MMC::updatePRGSlots() {
+    const unsigned int prgSlotCount = 8;
+    const uint16_t prgROMStart = 0x8000;
+    const uint16_t prgSlotSize = 0x1000;
+    for (unsigned int i = 0; i < prgSlotCount; ++i) {
+        const unsigned int localAddr = getLocalPRGAddr(prgROMStart + i * prgSlotSize);
+        prgSlots[i] = prgROM + localAddr % prgROMBytes;
+    }
+}
+
+// Points each CHR slot to the CHR bank that is swapped into it. Banks past the end of the CHR
+// memory wrap around to the start, which is what happens with the unused upper bits of the bank
+// number
+
+void MMC::updateCHRSlots() {
+    const unsigned int chrSlotCount = 8;
+    const uint16_t chrSlotSize = 0x400;
+    for (unsigned int i = 0; i < chrSlotCount; ++i) {
+        const unsigned int localAddr = getLocalCHRAddr(i * chrSlotSize);
+        chrSlots[i] = chrMemory + localAddr % chrMemoryBytes;
+    }
+}
+
+// Points the PRG-ROM and CHR memory to this MMC's own copies if it has them or else to the ROM
+// image, and then points the slots into them. Used whenever the own copies were replaced as a whole
+
+void MMC::updateMemoryPointers() {
+    if (ownPRGROM.empty()) {
+        prgROM = rom->getPRGROM();
+    } else {
+        prgROM = ownPRGROM.data();
+    }
+    if (ownCHRMemory.empty()) {
+        chrMemory = rom->getCHRROM();
+        chrMemoryBytes = rom->getHeader().chrROMBytes;
+    } else {
+        chrMemory = ownCHRMemory.data();
+        chrMemoryBytes = ownCHRMemory.size();
+    }
+    updatePRGSlots();
+    updateCHRSlots();
+}
+
+// Gives this MMC its own copy of the PRG-ROM so that test mode can write to it without changing
+// the shared ROM image. Returns true if the copy was just made, which moves all of the PRG slots
+
+bool MMC::copyPRGROM() {
+    if (!ownPRGROM.empty()) {
+        return false;
+    }
+    ownPRGROM.assign(prgROM, prgROM + prgROMBytes);
+    prgROM = ownPRGROM.data();
+    updatePRGSlots();
+    return true;
+}
+
+// Gives this MMC its own copy of the CHR-ROM so that test mode can write to it without changing
+// the shared ROM image. CHR-RAM is already this MMC's own
+
+void MMC::copyCHRMemory() {
+    if (!ownCHRMemory.empty()) {
+        return;
+    }
+    ownCHRMemory.assign(chrMemory, chrMemory + chrMemoryBytes);
+    chrMemory = ownCHRMemory.data();
+    updateCHRSlots();
+}
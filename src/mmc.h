@@ -4,31 +4,43 @@
 #pragma once
 class PPU;
 
+#include <algorithm>
 #include <climits>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "ppu.h"
+#include "rom-image.h"
+#include "save-state.h"
 
 // Memory Management Controller (Mapper)
 // Handles anything related to the cartridge. Stores data for addresses $4020 - $7fff (PRG-RAM) and
 // $8000 - $ffff (PRG-ROM) in the CPU memory map as well as addresses $0000 - $1fff (CHR memory or
-// pattern tables) in the PPU memory map
+// pattern tables) in the PPU memory map. The PRG-ROM and CHR-ROM are read straight out of a shared
+// ROM image, so only the PRG-RAM and CHR-RAM belong to each MMC
 
 class MMC {
     public:
         MMC();
+        MMC(const MMC& other);
+        MMC& operator=(const MMC& other);
         void clear();
         uint8_t readPRG(const uint16_t addr) const;
-        void writePRG(const uint16_t addr, const uint8_t val, const unsigned int totalCycles);
+        bool writePRG(const uint16_t addr, const uint8_t val, const unsigned int totalCycles);
+        const uint8_t* getPRGPage(const uint8_t page) const;
+        uint8_t* getPRGRAMPage(const uint8_t page);
         uint8_t readCHR(const uint16_t addr) const;
         void writeCHR(const uint16_t addr, const uint8_t val);
         void readInInst(const std::string& filename);
-        void readInINES(const std::string& filename);
+        bool loadImage(const std::shared_ptr<const ROMImage>& image);
         unsigned int getMirroring() const;
+        void saveState(StateWriter& writer) const;
+        bool loadState(StateReader& reader);
+        static bool isMapperSupported(const unsigned int mapperID);
 
         enum Mirroring {
             Horizontal = 0,
@@ -43,11 +55,21 @@ class MMC {
     private:
         // PRG-RAM (i.e., additional workspace for the program)
         uint8_t prgRAM[0x8000 - 0x4020];
-        // PRG-ROM (i.e., the program)
-        std::vector<uint8_t> prgROM;
-        // CHR-ROM (i.e., character data, which are pattern tables) and CHR-RAM (i.e., additional
-        // work space or modifiable pattern tables)
-        std::vector<uint8_t> chrMemory;
+        // The .NES file that is loaded. Every MMC that has the same file loaded shares it
+        std::shared_ptr<const ROMImage> rom;
+        // PRG-ROM (i.e., the program). Points into the ROM image unless this MMC has its own copy
+        const uint8_t* prgROM;
+        size_t prgROMBytes;
+        // CHR-ROM (i.e., character data, which are pattern tables) or CHR-RAM (i.e., additional
+        // work space or modifiable pattern tables). Points into the ROM image unless CHR-RAM is
+        // enabled or this MMC has its own copy
+        const uint8_t* chrMemory;
+        size_t chrMemoryBytes;
+        // This MMC's own copy of the PRG-ROM, which is only made once test mode writes to it
+        std::vector<uint8_t> ownPRGROM;
+        // This MMC's own CHR memory. Holds the CHR-RAM, or a copy of the CHR-ROM once test mode
+        // writes to it
+        std::vector<uint8_t> ownCHRMemory;
         // Number of PRG banks
         unsigned int prgROMSize;
         // Number of CHR banks
@@ -78,6 +100,13 @@ class MMC {
         unsigned int lastWriteCycle;
         // Set to true for instruction tests, which allows them to write to the PRG-ROM
         bool testMode;
+        // Where the PRG-ROM that is swapped into each 4 KB slot of $8000 - $ffff in the CPU memory
+        // map starts. Updated whenever the PRG banks change so that reads don't recompute them
+        const uint8_t* prgSlots[8];
+        // Where the CHR memory that is swapped into each 1 KB slot of $0000 - $1fff in the PPU
+        // memory map starts. Updated whenever the CHR banks change so that reads don't recompute
+        // them
+        const uint8_t* chrSlots[8];
 
         unsigned int getLocalPRGAddr(const unsigned int addr) const;
         unsigned int getMapper1PRGAddr(const unsigned int addr) const;
@@ -87,7 +116,12 @@ class MMC {
         void writeShiftRegister(const uint16_t addr, const uint8_t val,
             const unsigned int totalCycles);
         void updateSettings(const uint16_t addr);
-        void expandCHRMemory(const unsigned int selectedCHRBank);
+        void expandCHRMemory();
+        bool copyPRGROM();
+        void copyCHRMemory();
+        void updateMemoryPointers();
+        void updatePRGSlots();
+        void updateCHRSlots();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+
+#include "nes-core.h"
+#include "option-parser.h"
+
+// How long each ROM runs for and how many times
+struct BenchOptions {
+    // Frames that are timed in each trial
+    unsigned int frames = 600;
+    // Frames that are run before the timed frames in each trial, so that the timing starts after
+    // the ROM's start-up code and with the caches warmed up
+    unsigned int warmUpFrames = 120;
+    unsigned int trials = 5;
+    // CPU options that every trial is run with, e.g., cpu=fast
+    std::vector<std::string> cpuOptions;
+};
+
+// What a ROM's timed frames emulated and how long each trial took to run them
+struct BenchResult {
+    std::string filename;
+    // Same in every trial, since the trials are checked to be identical
+    uint64_t cpuCycles;
+    uint64_t ppuDots;
+    std::vector<double> seconds;
+};
+
+struct BenchOptions readInBenchOptions(NESCore& core, int argc, char* argv[]);
+
+struct BenchResult runBenchmark(NESCore& core, const std::string& filename,
+    const struct BenchOptions& options);
+
+void runFrames(NESCore& core, const std::string& filename, const unsigned int frames);
+
+double getMedian(std::vector<double> values);
+
+void printResults(const struct BenchOptions& options,
+    const std::vector<struct BenchResult>& results);
+
+// Runs every bundled test ROM headless for a fixed number of frames and prints how fast they were
+// emulated as JSON. Has to be run from the root of the repo, where the ROMs are
+int main(int argc, char* argv[]) {
+    NESCore core;
+    const struct BenchOptions options = readInBenchOptions(core, argc, argv);
+    // The same ROMs are always run so that the results can be compared from commit to commit.
+    // Between them, they cover every instruction, CPU timing, and the PPU's sprite 0 hits
+    const std::vector<std::string> filenames = {
+        "test/nestest/nestest.nes",
+        "test/instr_test-v5/all_instrs.nes",
+        "test/ppu_sprite_hit/ppu_sprite_hit.nes",
+        "test/cpu_timing_test6/cpu_timing_test.nes"
+    };
+
+    std::vector<struct BenchResult> results;
+    for (const std::string& filename : filenames) {
+        results.push_back(runBenchmark(core, filename, options));
+    }
+    printResults(options, results);
+    return 0;
+}
+
+// Reads in frames=N (600 by default), warmup=N (120 by default), trials=N (5 by default), and the
+// CPU options that the emulator takes, which are applied to the core right away
+
+struct BenchOptions readInBenchOptions(NESCore& core, int argc, char* argv[]) {
+    struct BenchOptions options;
+    OptionParser parser("benchmark", argc, argv, 1);
+    while (parser.next()) {
+        const std::string& key = parser.getKey();
+        if (core.setOption(parser.getArg())) {
+            options.cpuOptions.push_back(parser.getArg());
+        } else if (key == "frames") {
+            options.frames = parser.getNumber(10, UINT_MAX);
+        } else if (key == "warmup") {
+            options.warmUpFrames = parser.getNumber(10, UINT_MAX);
+        } else if (key == "trials") {
+            options.trials = parser.getNumber(10, UINT_MAX);
+        } else {
+            parser.reject();
+        }
+    }
+    if (options.frames == 0 || options.trials == 0) {
+        std::cerr << "Benchmark needs at least one frame and one trial\n";
+        exit(1);
+    }
+    return options;
+}
+
+// Times the ROM's frames in each trial. Every trial starts from power on, so they all have to end
+// with the same frame and RAM. Exits if they don't, since the timings wouldn't be comparable
+
+struct BenchResult runBenchmark(NESCore& core, const std::string& filename,
+        const struct BenchOptions& options) {
+    // The ROM is only mapped into memory once and shared by every trial
+    std::string error;
+    const std::shared_ptr<const ROMImage> rom = ROMImage::fromFile(filename, error);
+    if (rom == nullptr) {
+        std::cerr << filename << ": " << error << "\n";
+        exit(1);
+    }
+    if (!NESCore::isSupported(*rom)) {
+        std::cerr << filename << " has a mapper that isn't supported\n";
+        exit(1);
+    }
+    struct BenchResult result;
+    result.filename = filename;
+    result.cpuCycles = 0;
+    result.ppuDots = 0;
+    uint32_t firstHash = 0;
+    for (unsigned int trial = 0; trial < options.trials; ++trial) {
+        core.load(rom);
+        runFrames(core, filename, options.warmUpFrames);
+
+        const unsigned int startCycles = core.getTotalCycles();
+        const unsigned int startDots = core.getTotalPPUCycles();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        runFrames(core, filename, options.frames);
+        const std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+        // The counters are unsigned, so the differences are right even if they wrapped around
+        const uint64_t cpuCycles = core.getTotalCycles() - startCycles;
+        const uint64_t ppuDots = core.getTotalPPUCycles() - startDots;
+        result.seconds.push_back(std::chrono::duration_cast<std::chrono::duration<double>>(finish -
+            start).count());
+
+        const uint32_t hash = core.hashOutput();
+        if (trial == 0) {
+            result.cpuCycles = cpuCycles;
+            result.ppuDots = ppuDots;
+            firstHash = hash;
+        } else if (hash != firstHash || cpuCycles != result.cpuCycles ||
+                ppuDots != result.ppuDots) {
+            std::cerr << "Trial " << trial + 1 << " of " << filename << " didn't run the same as "
+                "the first trial\n";
+            exit(1);
+        }
+    }
+    return result;
+}
+
+// Runs whole frames. Exits if the machine stops in the middle of one
+
+void runFrames(NESCore& core, const std::string& filename, const unsigned int frames) {
+    for (unsigned int i = 0; i < frames; ++i) {
+        if (core.runFrame() != NESCore::FrameDone) {
+            std::cerr << filename << " stopped before the end of a frame\n";
+            exit(1);
+        }
+    }
+}
+
+double getMedian(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    if (values.size() % 2 == 0) {
+        return (values[middle - 1] + values[middle]) / 2;
+    }
+    return values[middle];
+}
+
+// Prints the results as JSON. The rates are worked out from each ROM's median trial, which isn't
+// thrown off by a trial that the OS interrupted. The nanoseconds per CPU cycle and per PPU dot are
+// the same time divided by either count, since the CPU and PPU are emulated together
+
+void printResults(const struct BenchOptions& options,
+        const std::vector<struct BenchResult>& results) {
+    std::cout << "{\n  \"frames\": " << options.frames << ",\n  \"warmup\": " <<
+        options.warmUpFrames << ",\n  \"trials\": " << options.trials << ",\n  \"options\": [";
+    for (size_t i = 0; i < options.cpuOptions.size(); ++i) {
+        if (i != 0) {
+            std::cout << ", ";
+        }
+        std::cout << "\"" << options.cpuOptions[i] << "\"";
+    }
+    std::cout << "],\n  \"roms\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const struct BenchResult& result = results[i];
+        const double median = getMedian(result.seconds);
+        const double best = *std::min_element(result.seconds.begin(), result.seconds.end());
+        std::cout << "    {\n      \"name\": \"" << result.filename << "\",\n"
+            "      \"cpu_cycles\": " << result.cpuCycles << ",\n"
+            "      \"ppu_dots\": " << result.ppuDots << ",\n"
+            "      \"seconds\": [";
+        for (size_t trial = 0; trial < result.seconds.size(); ++trial) {
+            if (trial != 0) {
+                std::cout << ", ";
+            }
+            std::cout << result.seconds[trial];
+        }
+        std::cout << "],\n      \"median_seconds\": " << median << ",\n"
+            "      \"best_seconds\": " << best;
+        // A run that's too short for the clock to measure has no rates
+        if (median > 0) {
+            std::cout << ",\n      \"frames_per_second\": " << options.frames / median << ",\n"
+                "      \"cpu_cycles_per_second\": " << result.cpuCycles / median << ",\n"
+                "      \"ppu_dots_per_second\": " << result.ppuDots / median << ",\n"
+                "      \"ns_per_cpu_cycle\": " << median * 1e9 / result.cpuCycles << ",\n"
+                "      \"ns_per_ppu_dot\": " << median * 1e9 / result.ppuDots;
+        }
+        std::cout << "\n    }";
+        if (i + 1 != results.size()) {
+            std::cout << ",";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "  ]\n}\n";
+}
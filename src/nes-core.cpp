@@ -0,0 +1,307 @@
+#include "nes-core.h"
+
+#include "cpu.h"
+#include "hash.h"
+
+// Everything that's behind NESCore's pointer
+
+struct NESCore::Machine {
+    // Start of every save state, which is "NESS" in ASCII
+    static constexpr uint32_t saveStateMagic = 0x5353454e;
+    // Version of the save state format. Has to be incremented whenever a field is added to,
+    // removed from, or moved around in the save state
+    static constexpr uint32_t saveStateVersion = 2;
+
+    CPU cpu;
+    // Number of frames that runFrame runs ahead of the frame that it displays. 0 turns run-ahead
+    // off
+    unsigned int runAheadFrames = 0;
+    // Set to false if frames are run without being displayed, e.g., while fast-forwarding
+    bool frameOutput = true;
+    // Number of bytes between the rows of the frame buffer
+    unsigned int framePitch = frameWidth * sizeof(uint32_t);
+    // State that runFrame goes back to after running ahead. Kept so that its memory is reused
+    std::vector<uint8_t> runAheadState;
+    // State of the machine from right before a state is loaded, which is loaded back if the state
+    // turns out to be bad partway through. Kept so that its memory is reused
+    std::vector<uint8_t> backupState;
+    // Audio samples of the last frame. Always empty since the APU isn't implemented yet
+    std::vector<int16_t> audioSamples;
+
+    bool loadState(const uint8_t* state, const size_t size);
+};
+
+NESCore::RunResult convertRunResult(const CPU::RunResult result);
+
+// Public Member Functions
+
+// The machine is on the heap since it's hundreds of KB
+
+NESCore::NESCore() : machine(std::make_unique<struct Machine>()) { }
+
+NESCore::NESCore(const NESCore& other) :
+        machine(std::make_unique<struct Machine>(*other.machine)) { }
+
+NESCore& NESCore::operator=(const NESCore& other) {
+    *machine = *other.machine;
+    return *this;
+}
+
+NESCore::~NESCore() { }
+
+// Resets the machine and loads the given .NES file, which is the whole file including the iNES
+// header. Returns false without changing the machine if it isn't a whole .NES file or its mapper
+// isn't supported. ROMImage::fromMemory gives the reason
+
+bool NESCore::load(const uint8_t* rom, const size_t size) {
+    std::string error;
+    const std::shared_ptr<const ROMImage> image = ROMImage::fromMemory(rom, size, error);
+    if (image == nullptr) {
+        return false;
+    }
+    return load(image);
+}
+
+// Resets the machine and loads the given ROM image. Loading the same image into many machines only
+// keeps one copy of the ROM in memory. Returns false without changing the machine if the image's
+// mapper isn't supported
+
+bool NESCore::load(const std::shared_ptr<const ROMImage>& rom) {
+    if (!isSupported(*rom)) {
+        return false;
+    }
+    machine->cpu.clear();
+    machine->cpu.loadImage(rom);
+    return true;
+}
+
+// Returns true if the image's mapper is one that the core can run
+
+bool NESCore::isSupported(const ROMImage& rom) {
+    return MMC::isMapperSupported(rom.getHeader().mapperID);
+}
+
+// Runs the machine until the PPU finishes the current frame. With run-ahead, the machine then runs
+// that many more frames with the same input, and only the last one is converted into the frame
+// buffer. The machine goes back to the end of the first frame afterwards, so the game still runs at
+// one frame per call, but the frame that's displayed already shows the reaction to the input. This
+// hides that many frames of the game's own input lag. If one of the frames ahead stops early
+// (e.g., at the breakpoint), the rest are skipped, and the machine gets there when it actually runs
+// that frame. There's nothing to run ahead for while frame output is turned off
+
+NESCore::RunResult NESCore::runFrame() {
+    CPU& cpu = machine->cpu;
+    if (machine->runAheadFrames == 0 || !machine->frameOutput) {
+        return convertRunResult(cpu.runFrame());
+    }
+    cpu.setFrameOutput(false);
+    const CPU::RunResult result = cpu.runFrame();
+    if (result != CPU::FrameDone) {
+        cpu.setFrameOutput(true);
+        return convertRunResult(result);
+    }
+    saveState(machine->runAheadState);
+    for (unsigned int i = 1; i <= machine->runAheadFrames; ++i) {
+        cpu.setFrameOutput(i == machine->runAheadFrames);
+        if (cpu.runFrame() != CPU::FrameDone) {
+            break;
+        }
+    }
+    cpu.setFrameOutput(true);
+    if (!loadState(machine->runAheadState.data(), machine->runAheadState.size())) {
+        return RunAheadFailed;
+    }
+    return convertRunResult(result);
+}
+
+// Executes up to the given number of CPU cycles, which can stop in the middle of a frame. Returns
+// early if the PC reaches the breakpoint. Run-ahead doesn't apply
+
+NESCore::RunResult NESCore::runCycles(const unsigned int cycles) {
+    return convertRunResult(machine->cpu.runCycles(cycles));
+}
+
+// Sets which buttons are held on the joystick in the given port (0 or 1). The mask depends on enum
+// IO::Button
+
+void NESCore::setInput(const unsigned int port, const uint8_t mask) {
+    machine->cpu.setButtons(port, mask);
+}
+
+// Returns the last finished frame as 240 rows of 256 ARGB pixels. The rows are 256 pixels apart
+// unless the frame memory was changed with setFrameBuffer
+
+const uint32_t* NESCore::frameBuffer() const {
+    return machine->cpu.getFrameBuffer();
+}
+
+// Makes the next frames get converted straight into the given memory, which has to hold 240 rows
+// of 256 ARGB pixels that are pitch bytes apart. nullptr switches back to the core's own memory
+
+void NESCore::setFrameBuffer(uint32_t* pixels, const unsigned int pitch) {
+    machine->framePitch = frameWidth * sizeof(uint32_t);
+    if (pixels != nullptr) {
+        machine->framePitch = pitch;
+    }
+    machine->cpu.setFrameBuffer(pixels, pitch);
+}
+
+// Turns converting frames into the frame buffer on or off, e.g., to skip the frames in between the
+// ones that are displayed while fast-forwarding. Frames that aren't output still run everything
+// that the game can see (sprite 0 hit and the other PPU flags), but skip looking up the color of
+// each pixel. The frame buffer keeps the last frame that was output
+
+void NESCore::setFrameOutput(const bool output) {
+    machine->frameOutput = output;
+    machine->cpu.setFrameOutput(output);
+}
+
+// Sets how many frames runFrame runs ahead of the frame that it displays. Every frame of run-ahead
+// costs a whole frame of emulation, but none of them are converted into the frame buffer except
+// the last one
+
+void NESCore::setRunAhead(const unsigned int frames) {
+    machine->runAheadFrames = frames;
+}
+
+const std::vector<int16_t>& NESCore::audioBuffer() const {
+    return machine->audioSamples;
+}
+
+// Replaces the contents of state with a snapshot of the whole machine. Reusing the same vector for
+// every snapshot avoids allocating memory once it's big enough
+
+void NESCore::saveState(std::vector<uint8_t>& state) {
+    state.clear();
+    StateWriter writer(state);
+    writer.write(Machine::saveStateMagic);
+    writer.write(Machine::saveStateVersion);
+    machine->cpu.saveState(writer);
+}
+
+// Restores the machine to a snapshot from saveState. The same ROM has to be loaded. Options (e.g.,
+// the render mode and frame memory) stay as they are, and the frame buffer keeps the last frame
+// that was finished before the state was loaded until the next frame is finished. Returns false
+// without changing the machine if the state isn't a save state, is from a different version of the
+// emulator or a different ROM, or is cut off or too long
+
+bool NESCore::loadState(const uint8_t* state, const size_t size) {
+    // A bad state can only be told apart partway through loading it, so the machine is saved
+    // first to be able to undo it
+    saveState(machine->backupState);
+    if (machine->loadState(state, size)) {
+        return true;
+    }
+    machine->loadState(machine->backupState.data(), machine->backupState.size());
+    return false;
+}
+
+// Applies an option that configures the machine, which are the same as the emulator's:
+// ppu=catchup or ppu=eager, cpu=fast or cpu=cycle, and render=scanline or render=dot. Returns
+// false if it isn't one of them
+
+bool NESCore::setOption(const std::string& option) {
+    return machine->cpu.setOption(option);
+}
+
+// Selects how the PPU outputs pixels. Takes effect at the start of the next frame
+
+void NESCore::setRenderMode(const RenderMode mode) {
+    if (mode == ScanlineRendering) {
+        machine->cpu.setPPURenderMode(PPU::ScanlineRendering);
+    } else {
+        machine->cpu.setPPURenderMode(PPU::DotRendering);
+    }
+}
+
+// Makes runFrame and runCycles stop once the PC reaches the given address
+
+void NESCore::setBreakpoint(const uint16_t addr) {
+    machine->cpu.setBreakpoint(addr);
+}
+
+void NESCore::clearBreakpoint() {
+    machine->cpu.clearBreakpoint();
+}
+
+// Reads from the RAM ($0000 - $1fff) or the cartridge ($4020 - $ffff) without side effects. The
+// registers in between can't be read without side effects, so they read as 0
+
+uint8_t NESCore::readMemory(const uint16_t addr) const {
+    const uint16_t ramEnd = 0x2000;
+    const uint16_t cartridgeStart = 0x4020;
+    if (addr < ramEnd) {
+        return machine->cpu.readRAM(addr);
+    } else if (addr >= cartridgeStart) {
+        return machine->cpu.readPRG(addr);
+    }
+    return 0;
+}
+
+unsigned int NESCore::getRunAhead() const {
+    return machine->runAheadFrames;
+}
+
+uint16_t NESCore::getPC() const {
+    return machine->cpu.getPC();
+}
+
+// Returns the number of CPU cycles since the ROM was loaded. Wraps around after 2^32 cycles
+
+unsigned int NESCore::getTotalCycles() const {
+    return machine->cpu.getTotalCycles();
+}
+
+// Returns the number of PPU cycles (dots) since the ROM was loaded. Wraps around after 2^32 cycles
+
+unsigned int NESCore::getTotalPPUCycles() const {
+    return machine->cpu.getTotalPPUCycles();
+}
+
+// Returns a hash (FNV-1a) of the last finished frame and the RAM, which is the same for any two
+// machines that show the same frame and have the same RAM. Meant for checking that two runs came
+// out the same
+
+uint32_t NESCore::hashOutput() const {
+    const uint8_t* pixels = (const uint8_t*) frameBuffer();
+    uint32_t hash = hashStart;
+    for (unsigned int y = 0; y < frameHeight; ++y) {
+        hash = hashBytes(pixels + y * machine->framePitch, frameWidth * sizeof(uint32_t), hash);
+    }
+    return hashBytes(getRAM(), ramSize, hash);
+}
+
+// Returns the 2 KB of RAM
+
+const uint8_t* NESCore::getRAM() const {
+    return machine->cpu.getRAM();
+}
+
+// Private Member Functions
+
+// Loads a state into the machine. Returns false if it's bad, in which case the machine can be
+// partly loaded
+
+bool NESCore::Machine::loadState(const uint8_t* state, const size_t size) {
+    StateReader reader(state, size);
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    reader.read(magic);
+    reader.read(version);
+    if (magic != saveStateMagic || version != saveStateVersion) {
+        return false;
+    }
+    return cpu.loadState(reader) && reader.isDone();
+}
+
+// Converts the CPU's reasons for returning into the core's. The CPU never ends the program since
+// NESCore doesn't halt at BRK
+
+NESCore::RunResult convertRunResult(const CPU::RunResult result) {
+    if (result == CPU::FrameDone) {
+        return NESCore::FrameDone;
+    } else if (result == CPU::BreakpointHit) {
+        return NESCore::BreakpointHit;
+    }
+    return NESCore::BudgetReached;
+}
@@ -0,0 +1,93 @@
+#ifndef NESCORE_H
+#define NESCORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rom-image.h"
+
+// NES Core
+// Interface for embedding the emulator in another program. It doesn't depend on SDL or any other
+// display stack: the program loads a ROM from memory, sets the joystick buttons, runs a frame at a
+// time, and reads the finished frame out of the frame buffer. Copying a core forks the machine:
+// the copy runs on from the same point without sharing any memory with the original. This and
+// everything that it depends on make up libnescore. The machine itself is hidden behind a pointer,
+// so that the CPU, PPU, and MMC can change without changing the layout of this class or requiring
+// their headers
+
+class NESCore {
+    public:
+        NESCore();
+        NESCore(const NESCore& other);
+        NESCore& operator=(const NESCore& other);
+        ~NESCore();
+        bool load(const uint8_t* rom, const size_t size);
+        bool load(const std::shared_ptr<const ROMImage>& rom);
+        static bool isSupported(const ROMImage& rom);
+
+        // Reasons for runFrame and runCycles to return
+        enum RunResult {
+            // The given number of cycles have been executed
+            BudgetReached,
+            // The PPU finished rendering a frame
+            FrameDone,
+            // The PC reached the breakpoint
+            BreakpointHit,
+            // The frame was done, but run-ahead couldn't load the state that it saved at the end of
+            // it, so the machine was left at the last frame that it ran ahead to
+            RunAheadFailed
+        };
+
+        // Ways for the PPU to output the background and sprites
+        enum RenderMode {
+            // Outputs every pixel on its own cycle (the default)
+            DotRendering,
+            // Outputs a whole scanline at once. Faster, but changes in the middle of a scanline
+            // only show up on the next scanline
+            ScanlineRendering
+        };
+
+        RunResult runFrame();
+        RunResult runCycles(const unsigned int cycles);
+        void setInput(const unsigned int port, const uint8_t mask);
+        const uint32_t* frameBuffer() const;
+        void setFrameBuffer(uint32_t* pixels, const unsigned int pitch);
+        void setRunAhead(const unsigned int frames);
+        void setFrameOutput(const bool output);
+        const std::vector<int16_t>& audioBuffer() const;
+        void saveState(std::vector<uint8_t>& state);
+        bool loadState(const uint8_t* state, const size_t size);
+
+        // Options
+        bool setOption(const std::string& option);
+        void setRenderMode(const RenderMode mode);
+
+        // Debugging
+        void setBreakpoint(const uint16_t addr);
+        void clearBreakpoint();
+        uint8_t readMemory(const uint16_t addr) const;
+        uint32_t hashOutput() const;
+
+        // Getters
+        unsigned int getRunAhead() const;
+        uint16_t getPC() const;
+        unsigned int getTotalCycles() const;
+        unsigned int getTotalPPUCycles() const;
+        const uint8_t* getRAM() const;
+
+        // Size of the frame buffer in pixels
+        static const unsigned int frameWidth = 256;
+        static const unsigned int frameHeight = 240;
+        // Size of the RAM in bytes
+        static const unsigned int ramSize = 0x800;
+
+    private:
+        struct Machine;
+
+        std::unique_ptr<struct Machine> machine;
+};
+
+#endif
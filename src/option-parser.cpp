@@ -0,0 +1,95 @@
+#include "option-parser.h"
+
+#include <cstdint>
+#include <iostream>
+
+// Public Member Functions
+
+// Starts at argv[first], which is the first argument after the run mode
+
+OptionParser::OptionParser(const std::string& mode, const int argc, char* argv[],
+        const int first) :
+        mode(mode),
+        argc(argc),
+        argv(argv),
+        index(first) { }
+
+// Reads in the next argument and splits it into its key and value. Returns false once there are
+// no arguments left. Exits if the argument isn't in the form of key=value
+
+bool OptionParser::next() {
+    if (index >= argc) {
+        return false;
+    }
+    arg = argv[index];
+    ++index;
+    const size_t equalsIndex = arg.find('=');
+    if (equalsIndex == std::string::npos || equalsIndex == 0 || equalsIndex + 1 == arg.size()) {
+        reject();
+    }
+    key = arg.substr(0, equalsIndex);
+    value = arg.substr(equalsIndex + 1);
+    return true;
+}
+
+// Returns the value of the current argument as a number in the given base (10 or 16). Exits if it
+// isn't one or if it's bigger than max
+
+unsigned int OptionParser::getNumber(const unsigned int base, const unsigned int max) const {
+    unsigned int number = 0;
+    if (!parseNumber(value, base, max, number)) {
+        reject();
+    }
+    return number;
+}
+
+// Prints that the current argument isn't one that the run mode takes and exits
+
+void OptionParser::reject() const {
+    std::cerr << "Unexpected " << mode << " argument \"" << arg << "\"\n";
+    exit(1);
+}
+
+// Reads in text as a number in the given base (10 or 16). Returns false if it's empty, has
+// anything other than digits of that base (including a sign or a "0x" prefix), or is bigger than
+// max, which std::stoul either accepts or throws for
+
+bool OptionParser::parseNumber(const std::string& text, const unsigned int base,
+        const unsigned int max, unsigned int& number) {
+    if (text.empty()) {
+        return false;
+    }
+    // Wide enough that adding one more digit to a number up to max can't overflow
+    uint64_t result = 0;
+    for (const char c : text) {
+        unsigned int digit = base;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        }
+        if (digit >= base) {
+            return false;
+        }
+        result = result * base + digit;
+        if (result > max) {
+            return false;
+        }
+    }
+    number = result;
+    return true;
+}
+
+const std::string& OptionParser::getArg() const {
+    return arg;
+}
+
+const std::string& OptionParser::getKey() const {
+    return key;
+}
+
+const std::string& OptionParser::getValue() const {
+    return value;
+}
@@ -0,0 +1,39 @@
+#ifndef OPTIONPARSER_H
+#define OPTIONPARSER_H
+
+#include <string>
+
+// Option Parser
+// Goes through the key=value arguments of a run mode (e.g., "frames=600 threads=4") one at a time.
+// An argument that isn't in that form, that has a key the run mode doesn't know, or that has a
+// value that isn't a number in range is printed as an unexpected argument of the run mode, and the
+// program exits
+
+class OptionParser {
+    public:
+        OptionParser(const std::string& mode, const int argc, char* argv[], const int first);
+        bool next();
+        unsigned int getNumber(const unsigned int base, const unsigned int max) const;
+        void reject() const;
+        static bool parseNumber(const std::string& text, const unsigned int base,
+            const unsigned int max, unsigned int& number);
+
+        // Getters
+        const std::string& getArg() const;
+        const std::string& getKey() const;
+        const std::string& getValue() const;
+
+    private:
+        // Name of the run mode in error messages, e.g., "headless"
+        std::string mode;
+        int argc;
+        char** argv;
+        // Index of the argument that next reads in
+        int index;
+        // The current argument and its two halves
+        std::string arg;
+        std::string key;
+        std::string value;
+};
+
+#endif
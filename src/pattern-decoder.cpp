@@ -0,0 +1,40 @@
+#include "pattern-decoder.h"
+
+// Public Member Functions
+
+// Decodes a tile row where the highest bit of each pattern entry is the leftmost pixel
+
+uint64_t PatternDecoder::decode(const uint8_t patternEntryLo, const uint8_t patternEntryHi) {
+    return spreadTable[patternEntryLo] | (spreadTable[patternEntryHi] << 1);
+}
+
+// Decodes a tile row that is flipped horizontally
+
+uint64_t PatternDecoder::decodeFlipped(const uint8_t patternEntryLo, const uint8_t patternEntryHi)
+        {
+    return flippedSpreadTable[patternEntryLo] | (flippedSpreadTable[patternEntryHi] << 1);
+}
+
+// Private Member Functions
+
+constexpr PatternDecoder::SpreadTable PatternDecoder::createSpreadTable(const bool flipped) {
+    SpreadTable table{};
+    const unsigned int tileRowSize = 8;
+    for (unsigned int entry = 0; entry < table.size(); ++entry) {
+        for (unsigned int pixel = 0; pixel < tileRowSize; ++pixel) {
+            // Without flipping, the highest bit is the leftmost pixel
+            unsigned int bit = tileRowSize - 1 - pixel;
+            if (flipped) {
+                bit = pixel;
+            }
+            if (entry & (1 << bit)) {
+                table[entry] |= (uint64_t) 1 << (pixel * 8);
+            }
+        }
+    }
+    return table;
+}
+
+// Both tables are constant-initialized at compile time since createSpreadTable is constexpr
+const PatternDecoder::SpreadTable PatternDecoder::spreadTable = createSpreadTable(false);
+const PatternDecoder::SpreadTable PatternDecoder::flippedSpreadTable = createSpreadTable(true);
\ No newline at end of file
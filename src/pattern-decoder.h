@@ -0,0 +1,31 @@
+#ifndef PATTERNDECODER_H
+#define PATTERNDECODER_H
+
+#include <array>
+#include <cstdint>
+
+// Pattern Decoder
+// Decodes the two pattern entries of a tile row into the 2-bit palettes of its 8 pixels in one
+// step, using lookup tables that are generated at compile time. Each byte of the result is one
+// pixel, where the lowest byte is the leftmost pixel. Bit 0 of each pixel comes from the low
+// pattern entry and bit 1 comes from the high pattern entry:
+// https://www.nesdev.org/wiki/PPU_pattern_tables
+
+class PatternDecoder {
+    public:
+        static uint64_t decode(const uint8_t patternEntryLo, const uint8_t patternEntryHi);
+        static uint64_t decodeFlipped(const uint8_t patternEntryLo, const uint8_t patternEntryHi);
+
+    private:
+        typedef std::array<uint64_t, 0x100> SpreadTable;
+
+        // Maps a pattern entry to its 8 bits spread out into the lowest bit of each byte. The
+        // flipped table is for sprites that are flipped horizontally, where the lowest bit of the
+        // pattern entry is the leftmost pixel instead of the highest bit
+        static const SpreadTable spreadTable;
+        static const SpreadTable flippedSpreadTable;
+
+        static constexpr SpreadTable createSpreadTable(const bool flipped);
+};
+
+#endif
@@ -9,6 +9,11 @@ PPUOp::PPUOp() :
         attributeEntry(0),
         patternEntryLo(0),
         patternEntryHi(0),
+        patternShiftLo(0),
+        patternShiftHi(0),
+        attributeShiftLo(0),
+        attributeShiftHi(0),
+        attributeLatch(0),
         oamEntry(0),
         spriteNum(0),
         oamEntryNum(0),
@@ -20,7 +25,10 @@ PPUOp::PPUOp() :
         suppressNMI(false),
         forceNMI(false),
         cycle(0),
-        status(0) { }
+        status(0),
+        sprite0HitCycle(0) {
+    memset(spriteLine, 0, 0x100);
+}
 
 void PPUOp::clear() {
     nametableAddr = 0x2000;
@@ -29,11 +37,15 @@ void PPUOp::clear() {
     attributeEntry = 0;
     patternEntryLo = 0;
     patternEntryHi = 0;
-    tileRows.clear();
+    patternShiftLo = 0;
+    patternShiftHi = 0;
+    attributeShiftLo = 0;
+    attributeShiftHi = 0;
+    attributeLatch = 0;
     oamEntry = 0;
     spriteNum = 0;
     oamEntryNum = 0;
-    currentSprites.clear();
+    memset(spriteLine, 0, 0x100);
     nextSprites.clear();
     scanline = 261;
     pixel = 0;
@@ -44,52 +56,146 @@ void PPUOp::clear() {
     forceNMI = false;
     cycle = 0;
     status = 0;
+    sprite0HitCycle = 0;
 }
 
-// Once a tile row has all of its data fetched, this function is called to push it to the queue for
-// future rendering
+// The sprites for the next scanline are written field by field, so that the padding in between the
+// fields doesn't end up in the save state
 
-void PPUOp::addTileRow() {
-    tileRows.push_back({nametableEntry, attributeEntry, patternEntryLo, patternEntryHi,
-        attributeQuadrant});
+void PPUOp::saveState(StateWriter& writer) const {
+    writer.write(nametableAddr);
+    writer.write(nametableEntry);
+    writer.write(attributeAddr);
+    writer.write(attributeEntry);
+    writer.write(patternEntryLo);
+    writer.write(patternEntryHi);
+    writer.write(patternShiftLo);
+    writer.write(patternShiftHi);
+    writer.write(attributeShiftLo);
+    writer.write(attributeShiftHi);
+    writer.write(attributeLatch);
+    writer.write(oamEntry);
+    writer.write(spriteNum);
+    writer.write(oamEntryNum);
+    writer.write(spriteLine);
+    const uint8_t spriteCount = nextSprites.size();
+    writer.write(spriteCount);
+    for (const Sprite& sprite : nextSprites) {
+        writer.write(sprite.yPos);
+        writer.write(sprite.tileIndexNum);
+        writer.write(sprite.attributes);
+        writer.write(sprite.xPos);
+        writer.write(sprite.patternEntryLo);
+        writer.write(sprite.patternEntryHi);
+        writer.write(sprite.spriteNum);
+    }
+    writer.write(scanline);
+    writer.write(pixel);
+    writer.write(attributeQuadrant);
+    writer.write(oddFrame);
+    writer.write(nmiOccurred);
+    writer.write(suppressNMI);
+    writer.write(forceNMI);
+    writer.write(cycle);
+    writer.write(status);
+    writer.write(sprite0HitCycle);
+}
+
+void PPUOp::loadState(StateReader& reader) {
+    reader.read(nametableAddr);
+    reader.read(nametableEntry);
+    reader.read(attributeAddr);
+    reader.read(attributeEntry);
+    reader.read(patternEntryLo);
+    reader.read(patternEntryHi);
+    reader.read(patternShiftLo);
+    reader.read(patternShiftHi);
+    reader.read(attributeShiftLo);
+    reader.read(attributeShiftHi);
+    reader.read(attributeLatch);
+    reader.read(oamEntry);
+    reader.read(spriteNum);
+    reader.read(oamEntryNum);
+    reader.read(spriteLine);
+    uint8_t spriteCount = 0;
+    reader.read(spriteCount);
+    nextSprites.resize(spriteCount);
+    for (Sprite& sprite : nextSprites) {
+        reader.read(sprite.yPos);
+        reader.read(sprite.tileIndexNum);
+        reader.read(sprite.attributes);
+        reader.read(sprite.xPos);
+        reader.read(sprite.patternEntryLo);
+        reader.read(sprite.patternEntryHi);
+        reader.read(sprite.spriteNum);
+    }
+    reader.read(scanline);
+    reader.read(pixel);
+    reader.read(attributeQuadrant);
+    reader.read(oddFrame);
+    reader.read(nmiOccurred);
+    reader.read(suppressNMI);
+    reader.read(forceNMI);
+    reader.read(cycle);
+    reader.read(status);
+    reader.read(sprite0HitCycle);
 }
 
-// Gets the background palette bits for the current pixel
+// Once a tile row for the start of the next scanline has all of its data fetched, this function is
+// called to shift the previous one into the high byte and load it into the low byte
 
-uint8_t PPUOp::getPalette(const uint8_t x) {
-    std::deque<TileRow>::iterator tileRowIterator = tileRows.begin();
+void PPUOp::prefetchTileRow() {
     const unsigned int tileRowSize = 8;
-    // If this condition is true, then the current pixel and fine X scroll is past the current tile,
-    // so the next tile row should be used instead
-    if (pixel % tileRowSize + x > tileRowSize - 1) {
-        ++tileRowIterator;
+    patternShiftLo <<= tileRowSize;
+    patternShiftHi <<= tileRowSize;
+    attributeShiftLo = 0;
+    attributeShiftHi = 0;
+    // Fill the attribute shift registers with the previous tile row's attribute latch
+    if (attributeLatch & 1) {
+        attributeShiftLo = 0xff;
     }
-    const uint8_t upperPaletteBits = getUpperPalette(*tileRowIterator);
-    uint8_t bgPalette = 0;
-    // Get the bit in the byte that represents the current pixel
-    const uint8_t pixelInTileRow = 0x80 >> ((pixel + x) % tileRowSize);
-    if (tileRowIterator->patternEntryLo & pixelInTileRow) {
-        bgPalette |= 1;
+    if (attributeLatch & 2) {
+        attributeShiftHi = 0xff;
     }
-    if (tileRowIterator->patternEntryHi & pixelInTileRow) {
-        bgPalette |= 2;
-    }
-    if (upperPaletteBits & 1) {
-        bgPalette |= 4;
-    }
-    if (upperPaletteBits & 2) {
-        bgPalette |= 8;
-    }
-    return bgPalette;
+    reloadShiftRegisters();
 }
 
-// Gets the upper 2 bits of the background palette for the current pixel
+// Loads the latest fetched tile row into the low byte of the pattern shift registers and the
+// attribute latch. The low byte has already been shifted out at this point
+
+void PPUOp::reloadShiftRegisters() {
+    patternShiftLo |= patternEntryLo;
+    patternShiftHi |= patternEntryHi;
+    attributeLatch = getUpperPalette();
+}
 
-uint8_t PPUOp::getUpperPalette(const struct TileRow& tileRow) const {
+// Shifts the background shift registers by one pixel
+
+void PPUOp::shiftRegisters() {
+    patternShiftLo <<= 1;
+    patternShiftHi <<= 1;
+    attributeShiftLo = (attributeShiftLo << 1) | (attributeLatch & 1);
+    attributeShiftHi = (attributeShiftHi << 1) | ((attributeLatch >> 1) & 1);
+}
+
+// Gets the background palette bits for the current pixel. The fine X scroll selects which bit of
+// the shift registers is the current pixel
+
+uint8_t PPUOp::getPalette(const uint8_t x) const {
+    const unsigned int patternBit = 15 - x;
+    const unsigned int attributeBit = 7 - x;
+    return ((patternShiftLo >> patternBit) & 1) | (((patternShiftHi >> patternBit) & 1) << 1) |
+        (((attributeShiftLo >> attributeBit) & 1) << 2) |
+        (((attributeShiftHi >> attributeBit) & 1) << 3);
+}
+
+// Gets the upper 2 bits of the background palette for the latest fetched tile row
+
+uint8_t PPUOp::getUpperPalette() const {
     unsigned int shiftNum = 0;
     // Which 2 bits to use out of the 8 bits in the attribute entry are determined by what the
     // current quadrant is: https://www.nesdev.org/wiki/PPU_attribute_tables
-    switch (tileRow.attributeQuadrant) {
+    switch (attributeQuadrant) {
         case TopRight:
             shiftNum = 2;
             break;
@@ -99,13 +205,42 @@ uint8_t PPUOp::getUpperPalette(const struct TileRow& tileRow) const {
         case BottomRight:
             shiftNum = 6;
     }
-    return (tileRow.attributeEntry >> shiftNum) & 3;
+    return (attributeEntry >> shiftNum) & 3;
+}
+
+// Pre-renders nextSprites into the sprite line so that each pixel only needs to look up its entry.
+// The sprites are prioritized in the order that they're listed in the OAM (sprite 0 being the most
+// prioritized), so only the first non-transparent sprite pixel is kept for each pixel
+
+void PPUOp::loadSpriteLine() {
+    memset(spriteLine, 0, 0x100);
+    const unsigned int spriteWidth = 8;
+    const unsigned int pixelsPerScanline = 256;
+    for (const Sprite& sprite : nextSprites) {
+        const uint64_t tileRow = sprite.decodeTileRow();
+        const uint8_t upperPaletteBits = sprite.getUpperPalette() << 2;
+        for (unsigned int i = 0; i < spriteWidth && sprite.xPos + i < pixelsPerScanline; ++i) {
+            const unsigned int spritePixel = sprite.xPos + i;
+            uint8_t palette = ((tileRow >> (i * 8)) & 3) | upperPaletteBits;
+            // If the lower 2 bits are zero, then the sprite pixel is transparent and a later
+            // sprite can still be shown there
+            if ((palette & 3) && !spriteLine[spritePixel]) {
+                if (!sprite.isPrioritized()) {
+                    palette |= BehindBGFlag;
+                }
+                if (sprite.spriteNum == 0) {
+                    palette |= Sprite0Flag;
+                }
+                spriteLine[spritePixel] = palette;
+            }
+        }
+    }
+    nextSprites.clear();
 }
 
 // Prepares anything else that needs to be updated for the next cycle
 
 void PPUOp::prepNextCycle() {
-    const unsigned int prerenderLine = 261;
     // Only update the operation status if the current cycle is associated with a valid fetch and
     // not an unused fetch
     if (canFetch()) {
@@ -113,11 +248,13 @@ void PPUOp::prepNextCycle() {
     }
 
     if (isRendering()) {
+        shiftRegisters();
         ++pixel;
         const unsigned int tileRowSize = 8;
-        // Every tile is 8x8, so pop the queue every 8 pixels
+        // Every tile is 8x8, so the next tile row is loaded every 8 pixels. It was fetched 3
+        // cycles ago and is still held in the pattern entries and attribute entry
         if (pixel % tileRowSize == 0) {
-            tileRows.pop_front();
+            reloadShiftRegisters();
         }
         const unsigned int pixelsPerScanline = 256;
         // Ensure that the pixel number wraparounds back to 0 after outputting the last pixel
@@ -126,29 +263,30 @@ void PPUOp::prepNextCycle() {
         }
     }
 
-    // Clear the force NMI flag before an NMI gets triggered too late
-    if (cycle == 3 && scanline == prerenderLine) {
-        forceNMI = false;
     // If the cycle is 256, then sprite evaluation is done and spriteNum can be reset and used for
     // sprite fetching next. oamEntryNum is reset for the next scanline's sprite evaluation
-    } else if (cycle == 256) {
+    if (cycle == 256) {
         spriteNum = 0;
         oamEntryNum = 0;
     // If the cycle is 320, then sprite fetching for the next scanline and rendering the current
-    // scanline are both done. These sprites for the next scanline can now be treated as the
-    // currentSprites to render
+    // scanline are both done. These sprites for the next scanline can now be pre-rendered into the
+    // sprite line
     } else if (cycle == 320) {
         spriteNum = 0;
-        currentSprites = nextSprites;
-        nextSprites.clear();
-        const unsigned int lastRenderLine = 239;
-        // After rendering the entire scanline, there is one tile row remaining in the queue that is
-        // past the right border of the frame, which is accessed by prior rendering functions when
-        // outputting one of the last 8 pixels and the fine X scroll is large enough. This ensures
-        // that the queue is empty for the next scanline
-        if (scanline <= lastRenderLine && !tileRows.empty()) {
-            tileRows.clear();
-        }
+        loadSpriteLine();
+    }
+
+    advanceCycle();
+}
+
+// Moves on to the next cycle, which can also be the next scanline or the next frame. The scanline
+// renderer only needs this part of prepNextCycle since it doesn't fetch or output pixels per cycle
+
+void PPUOp::advanceCycle() {
+    const unsigned int prerenderLine = 261;
+    // Clear the force NMI flag before an NMI gets triggered too late
+    if (cycle == 3 && scanline == prerenderLine) {
+        forceNMI = false;
     }
 
     const unsigned int lastCycle = 340;
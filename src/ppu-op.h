@@ -1,9 +1,10 @@
 #ifndef PPUOP_H
 #define PPUOP_H
 
-#include <deque>
+#include <cstring>
 #include <vector>
 
+#include "save-state.h"
 #include "sprite.h"
 
 // PPU Operation
@@ -16,17 +17,10 @@ class PPUOp {
     public:
         PPUOp();
         void clear();
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
 
     private:
-        // Required data for rendering a background tile row
-        struct TileRow {
-            uint8_t nametableEntry;
-            uint8_t attributeEntry;
-            uint8_t patternEntryLo;
-            uint8_t patternEntryHi;
-            unsigned int attributeQuadrant;
-        };
-
         // Address of the nametable byte
         uint16_t nametableAddr;
         // Nametable byte that points to a 8x8 pattern table
@@ -39,19 +33,29 @@ class PPUOp {
         uint8_t patternEntryLo;
         // Row of a pattern table that has bit 1 of 4-bit color for 8x1 pixels
         uint8_t patternEntryHi;
-        // Queue that stores the next background tile rows to render. The PPU pre-fetches 2 tile
-        // rows in advance before rendering. Additionally, rendering doesn't start until cycle 4
-        // while fetching a third tile row, so this queue will only ever contain a max of 3 tile
-        // rows at a time
-        std::deque<struct TileRow> tileRows;
+        // Background pattern shift registers: https://www.nesdev.org/wiki/PPU_rendering#Preface.
+        // The high byte is the tile row being rendered and the low byte is the next tile row. The
+        // PPU pre-fetches 2 tile rows in advance before rendering, which fill both bytes. Both
+        // registers are shifted left once per output pixel, and the low byte is reloaded from the
+        // latest fetched tile row every 8 pixels
+        uint16_t patternShiftLo;
+        uint16_t patternShiftHi;
+        // Shift registers for bit 2 and 3 of the background palette of the next 8 pixels. They're
+        // shifted along with the pattern shift registers and refilled from the attribute latch
+        uint8_t attributeShiftLo;
+        uint8_t attributeShiftHi;
+        // Bit 2 and 3 of the background palette for the next tile row
+        uint8_t attributeLatch;
         // OAM byte that has info about the current sprite
         uint8_t oamEntry;
         // Current sprite number out of the 64 sprites in the OAM (0 - 63)
         unsigned int spriteNum;
         // Current OAM byte out of the 4 bytes of sprite info (0 - 3)
         unsigned int oamEntryNum;
-        // Sprites that are to be rendered on the current scanline
-        std::vector<Sprite> currentSprites;
+        // Sprite pixels of the current scanline, pre-rendered once the sprites for it are done
+        // being fetched. Each entry is the palette of the first non-transparent sprite on that
+        // pixel (bits 0 - 3) and the flags in enum SpritePixelFlag. 0 if there's no sprite there
+        uint8_t spriteLine[256];
         // Sprites that are to be rendered on the next scanline
         std::vector<Sprite> nextSprites;
         // Current scanline out of 262 total scanlines (0 - 261)
@@ -75,14 +79,23 @@ class PPUOp {
         unsigned int cycle;
         // Indicates any cycle-relevant info about the operation. Depends on the enum Status
         unsigned int status;
+        // Cycle of the current scanline that the scanline renderer sets the sprite 0 hit flag on. 0
+        // if there's no sprite 0 hit on the current scanline
+        unsigned int sprite0HitCycle;
 
         // Backgrounds
-        void addTileRow();
-        uint8_t getPalette(const uint8_t x);
-        uint8_t getUpperPalette(const struct TileRow& tileRow) const;
+        void prefetchTileRow();
+        void reloadShiftRegisters();
+        void shiftRegisters();
+        uint8_t getPalette(const uint8_t x) const;
+        uint8_t getUpperPalette() const;
+
+        // Sprites
+        void loadSpriteLine();
 
         // Preparation for Next Cycle
         void prepNextCycle();
+        void advanceCycle();
         void updateStatus();
 
         // Miscellaneous Functions
@@ -98,6 +111,12 @@ class PPUOp {
             BottomLeft = 2,
             BottomRight = 3
         };
+        enum SpritePixelFlag {
+            // Set if the sprite is behind the background
+            BehindBGFlag = 0x10,
+            // Set if the sprite is sprite 0
+            Sprite0Flag = 0x20
+        };
         enum OpStatus {
             FetchNametableEntry = 0,
             FetchAttributeEntry = 1,
@@ -8,8 +8,14 @@ PPU::PPU() :
         t(0),
         x(0),
         w(false),
+        framePixels(nullptr),
+        framePitch(sizeof(frame[0]) * 256),
+        frameOutput(true),
         ppuDataBuffer(0),
-        totalCycles(0) {
+        totalCycles(0),
+        frameDone(false),
+        renderMode(DotRendering),
+        nextRenderMode(DotRendering) {
     memset(registers, 0, 8);
     const uint16_t universalBGColorAddr = 0x3f00;
     const uint16_t nametableMirrorSize = 0xf00;
@@ -20,7 +26,11 @@ PPU::PPU() :
         (nametableSize + attributeTableSize) * 2 - patternTableSize * 2;
     const uint8_t black = 0xf;
     vram[universalBGColorLocalAddr] = black;
+    memset(frame, 0, sizeof(frame));
+    memset(framePaletteEntries, 0, sizeof(framePaletteEntries));
+    memset(lineColorModes, 0, sizeof(lineColorModes));
     initializePalette();
+    initializeColors();
 }
 
 void PPU::clear() {
@@ -43,21 +53,29 @@ void PPU::clear() {
         (nametableSize + attributeTableSize) * 2 - patternTableSize * 2;
     const uint8_t black = 0xf;
     vram[universalBGColorLocalAddr] = black;
-    const unsigned int frameWidth = 256;
-    const unsigned int frameHeight = 240;
-    const unsigned int bytesPerPixel = 4;
-    memset(frame, 0, frameWidth * frameHeight * bytesPerPixel);
+    memset(frame, 0, sizeof(frame));
+    memset(framePaletteEntries, 0, sizeof(framePaletteEntries));
+    memset(lineColorModes, 0, sizeof(lineColorModes));
     ppuDataBuffer = 0;
     op.clear();
     totalCycles = 0;
+    frameDone = false;
 }
 
 // Executes exactly one PPU cycle
 
-void PPU::step(MMC& mmc, SDL_Renderer* renderer, SDL_Texture* texture, const bool mute) {
-    skipCycle0();
+void PPU::step(MMC& mmc, const bool mute) {
     const unsigned int lastRenderLine = 239;
     const unsigned int prerenderLine = 261;
+    if (renderMode != nextRenderMode && op.cycle == 0 && op.scanline == prerenderLine) {
+        switchRenderMode();
+    }
+    if (renderMode == ScanlineRendering) {
+        stepScanline(mmc);
+        return;
+    }
+
+    skipCycle0();
     if (op.scanline <= lastRenderLine || op.scanline == prerenderLine) {
         if (op.canFetch()) {
             fetch(mmc);
@@ -72,15 +90,19 @@ void PPU::step(MMC& mmc, SDL_Renderer* renderer, SDL_Texture* texture, const boo
                 evaluateSprites();
             }
         }
-        if (op.isRendering()) {
-            setPixel(mmc);
-        }
         const unsigned int firstPixelOutputCycle = 4;
         const unsigned int lastPixelOutputCycle = firstPixelOutputCycle + 255;
+        if (op.cycle == firstPixelOutputCycle && op.scanline <= lastRenderLine && frameOutput) {
+            lineColorModes[op.scanline] = getColorMode();
+        }
+        if (op.isRendering()) {
+            setPixel(op.getPalette(x), mmc);
+        }
         // If the current scanline is the last render line, and the current cycle is the last cycle
         // to set a pixel in the frame, then the frame is ready to be rendered
         if (op.scanline == lastRenderLine && op.cycle == lastPixelOutputCycle) {
-            renderFrame(renderer, texture);
+            renderFrame();
+            frameDone = true;
         }
     }
     if (isRenderingEnabled()) {
@@ -93,6 +115,30 @@ void PPU::step(MMC& mmc, SDL_Renderer* renderer, SDL_Texture* texture, const boo
     ++totalCycles;
 }
 
+// Executes the given number of PPU cycles. The CPU either runs 3 cycles for every CPU cycle or
+// catches the PPU up in bulk. Returns true if the frame was rendered during these cycles
+
+bool PPU::runCycles(const unsigned int cycles, MMC& mmc, const bool mute) {
+    frameDone = false;
+    unsigned int i = 0;
+    while (i < cycles) {
+        // The scanline renderer has nothing to do on most cycles, so those are skipped over
+        if (renderMode == ScanlineRendering) {
+            const unsigned int idleCycles = std::min(getNextScanlineEventCycle() - op.cycle,
+                cycles - i);
+            op.cycle += idleCycles;
+            totalCycles += idleCycles;
+            i += idleCycles;
+            if (i == cycles) {
+                break;
+            }
+        }
+        step(mmc, mute);
+        ++i;
+    }
+    return frameDone;
+}
+
 // Handles register reads from the CPU
 
 uint8_t PPU::readRegister(const uint16_t addr, MMC& mmc) {
@@ -207,14 +253,136 @@ bool PPU::isNMIActive(MMC& mmc, const bool mute) {
     return false;
 }
 
+// Tells the CPU whether an NMI could become active within the given number of cycles. If not, the
+// CPU can poll for interrupts without catching the PPU up first. Only PPUCTRL writes can enable
+// NMIs, and the CPU catches the PPU up before those, so the only other ways for isNMIActive to
+// change are an NMI that is already pending or the PPU reaching the start of vblank
+
+bool PPU::isNMIPossible(const unsigned int cycles) const {
+    if (!isNMIEnabled()) {
+        return false;
+    }
+    if (op.forceNMI || (isVblank() && !op.nmiOccurred && !op.suppressNMI)) {
+        return true;
+    }
+    const unsigned int vblankLine = 241;
+    return cycles >= getCyclesUntil(vblankLine, 1);
+}
+
+// Returns the minimum number of cycles that the PPU runs before the cycle that renders the frame
+
+unsigned int PPU::getCyclesUntilFrameEnd() const {
+    const unsigned int lastRenderLine = 239;
+    const unsigned int firstPixelOutputCycle = 4;
+    const unsigned int lastPixelOutputCycle = firstPixelOutputCycle + 255;
+    return getCyclesUntil(lastRenderLine, lastPixelOutputCycle);
+}
+
 unsigned int PPU::getTotalCycles() const {
     return totalCycles;
 }
 
+// Returns the memory that the last frame was converted into
+
+const uint32_t* PPU::getFrameBuffer() const {
+    if (framePixels == nullptr) {
+        return frame;
+    }
+    return framePixels;
+}
+
 void PPU::clearTotalCycles() {
     totalCycles = 0;
 }
 
+// Selects how the PPU outputs pixels. Takes effect once the PPU reaches the pre-render line, which
+// is immediately after initialization or clear
+
+void PPU::setRenderMode(const unsigned int mode) {
+    nextRenderMode = mode;
+}
+
+// Makes the PPU convert each frame straight into the given memory instead of its own frame, e.g., a
+// locked texture or a buffer owned by an embedding program. The memory has to hold 240 rows of 256
+// ARGB pixels, where each row starts pitch bytes after the previous one. If pixels is nullptr, the
+// PPU's own frame is used again
+
+void PPU::setFrameBuffer(uint32_t* pixels, const unsigned int pitch) {
+    if (pixels == nullptr) {
+        framePixels = nullptr;
+        framePitch = sizeof(frame[0]) * 256;
+    } else {
+        framePixels = pixels;
+        framePitch = pitch;
+    }
+}
+
+// Turns the output of pixels on or off. While it's off, the PPU still fetches tiles and sprites and
+// sets sprite 0 hit and the other flags on the same cycles, but it doesn't look up the palette
+// entry of each pixel or convert finished frames, so the frame memory keeps the last frame that was
+// converted. Takes effect on the next pixel, so it should be changed in between frames
+
+void PPU::setFrameOutput(const bool output) {
+    frameOutput = output;
+}
+
+// Saves everything that affects what the PPU does next. The frame memory isn't saved since it's
+// only output, and only the lines of the current frame that have been output so far are saved out
+// of framePaletteEntries, which is none of them once the frame has been rendered. The render mode
+// is saved so that a state from the middle of a frame carries on with the same renderer, while a
+// different render mode that was selected still takes effect on the pre-render line
+
+void PPU::saveState(StateWriter& writer) const {
+    writer.write(registers);
+    writer.write(oamDMA);
+    writer.write(v);
+    writer.write(t);
+    writer.write(x);
+    writer.write(w);
+    writer.write(oam);
+    writer.write(secondaryOAM);
+    writer.write(vram);
+    const uint16_t outputLines = getOutputLineCount();
+    writer.write(outputLines);
+    writer.write(framePaletteEntries, outputLines * 256);
+    writer.write(lineColorModes, outputLines);
+    writer.write(ppuDataBuffer);
+    op.saveState(writer);
+    writer.write(totalCycles);
+    writer.write(frameDone);
+    writer.write(renderMode);
+}
+
+// The frame memory keeps the last frame that was rendered before the state was loaded until the
+// next frame is rendered. Returns false if the state has more lines than a frame or is too short,
+// in which case the PPU has to be restored by the caller
+
+bool PPU::loadState(StateReader& reader) {
+    reader.read(registers);
+    reader.read(oamDMA);
+    reader.read(v);
+    reader.read(t);
+    reader.read(x);
+    reader.read(w);
+    reader.read(oam);
+    reader.read(secondaryOAM);
+    reader.read(vram);
+    uint16_t outputLines = 0;
+    reader.read(outputLines);
+    const unsigned int frameHeight = 240;
+    if (outputLines > frameHeight) {
+        return false;
+    }
+    reader.read(framePaletteEntries, outputLines * 256);
+    reader.read(lineColorModes, outputLines);
+    reader.read(ppuDataBuffer);
+    op.loadState(reader);
+    reader.read(totalCycles);
+    reader.read(frameDone);
+    reader.read(renderMode);
+    return !reader.hasFailed();
+}
+
 void PPU::print(const bool isCycleDone) const {
     unsigned int inc = 0;
     std::string time;
@@ -272,6 +440,22 @@ void PPU::skipCycle0() {
     }
 }
 
+// Returns the number of cycles from the current cycle to the given scanline and cycle. If the count
+// includes the start of a frame, it's reduced by 2 to stay a lower bound, since the skipped cycle 0
+// and the PPUMASK edge cases in writeRegister can shorten the frame. Used by the CPU to decide when
+// the PPU has to be caught up
+
+unsigned int PPU::getCyclesUntil(const unsigned int scanline, const unsigned int cycle) const {
+    const unsigned int cyclesPerScanline = 341;
+    const unsigned int cyclesPerFrame = cyclesPerScanline * 262;
+    const unsigned int current = op.scanline * cyclesPerScanline + op.cycle;
+    const unsigned int target = scanline * cyclesPerScanline + cycle;
+    if (current <= target && current != 0) {
+        return target - current;
+    }
+    return (target + cyclesPerFrame - current) % cyclesPerFrame - 2;
+}
+
 // Fetches data from the nametables, attribute tables, and pattern tables, which is then used later
 // to form a palette index for a given pixel
 
@@ -301,8 +485,11 @@ void PPU::fetch(MMC& mmc) {
             addr = op.nametableEntry * 0x10 + fineYScroll + getBGPatternAddr() + 8;
             op.patternEntryHi = readVRAM(addr, mmc);
             // The high byte of the pattern entry is the last fetch of the tile row, so that means
-            // all info is done being fetched
-            op.addTileRow();
+            // all info is done being fetched. Tile rows fetched while rendering are loaded into the
+            // shift registers every 8 pixels instead
+            if (!op.isRendering()) {
+                op.prefetchTileRow();
+            }
             break;
         case PPUOp::FetchSpriteEntryLo:
             if (op.spriteNum < op.nextSprites.size()) {
@@ -398,6 +585,22 @@ void PPU::updateAttribute() {
 
 void PPU::fetchSpriteEntry(MMC& mmc) {
     Sprite& sprite = op.nextSprites[op.spriteNum];
+    uint16_t addr = getSpriteTileRowAddr(sprite, op.scanline);
+    if (op.status == PPUOp::FetchSpriteEntryLo) {
+        sprite.patternEntryLo = readVRAM(addr, mmc);
+    } else {
+        // Each tile row has a low pattern entry and a high pattern entry. The low entries are
+        // listed first (0 - 7) then the high entries are listed (8 - 0xf). E.g., the first tile row
+        // would be located at 0 and 8, the second would be 1 and 9, etc.
+        addr += 0x8;
+        sprite.patternEntryHi = readVRAM(addr, mmc);
+        ++op.spriteNum;
+    }
+}
+
+// Returns the address of the sprite's low pattern entry for the tile row on the given scanline
+
+uint16_t PPU::getSpriteTileRowAddr(const Sprite& sprite, const unsigned int scanline) const {
     uint16_t basePatternAddr = getSpritePatternAddr();
     const unsigned int spriteHeight = getSpriteHeight();
     uint8_t tileIndexNum = sprite.tileIndexNum;
@@ -415,18 +618,8 @@ void PPU::fetchSpriteEntry(MMC& mmc) {
     }
 
     uint16_t addr = basePatternAddr + tileIndexNum * patternEntriesPerSprite;
-    unsigned int tileRowIndex = sprite.getTileRowIndex(op.scanline, spriteHeight);
-    addr += tileRowIndex;
-    if (op.status == PPUOp::FetchSpriteEntryLo) {
-        sprite.patternEntryLo = readVRAM(addr, mmc);
-    } else {
-        // Each tile row has a low pattern entry and a high pattern entry. The low entries are
-        // listed first (0 - 7) then the high entries are listed (8 - 0xf). E.g., the first tile row
-        // would be located at 0 and 8, the second would be 1 and 9, etc.
-        addr += 0x8;
-        sprite.patternEntryHi = readVRAM(addr, mmc);
-        ++op.spriteNum;
-    }
+    unsigned int tileRowIndex = sprite.getTileRowIndex(scanline, spriteHeight);
+    return addr + tileRowIndex;
 }
 
 // Clears the secondary OAM before sprite evaluation
@@ -490,37 +683,32 @@ void PPU::evaluateSprites() {
     }
 }
 
-// Performs all rendering logic for the current pixel in the frame
+// Performs all rendering logic for the current pixel in the frame, given the background palette of
+// the pixel
 
-void PPU::setPixel(MMC& mmc) {
-    const uint8_t bgPalette = op.getPalette(x);
+void PPU::setPixel(const uint8_t bgPalette, MMC& mmc) {
     const uint8_t bgPaletteLower = bgPalette & 3;
-    uint8_t spritePalette = 0;
-    uint8_t spritePaletteLower = 0;
-    std::vector<Sprite>::iterator spriteIterator;
-    bool foundSprite = false;
-    for (spriteIterator = op.currentSprites.begin(); spriteIterator != op.currentSprites.end();
-            ++spriteIterator) {
-        // If the sprite is in range of the current pixel, then it needs to be considered for
-        // rendering. The first sprite found is used, even if there are other sprites in range. The
-        // sprites are prioritized in the order that they're listed in the OAM (sprite 0 being the
-        // most prioritized)
-        if (spriteIterator->isXInRange(op.pixel)) {
-            spritePalette = spriteIterator->getPalette(op.pixel);
-            spritePaletteLower = spritePalette & 3;
-            // If the lower 2 bits are nonzero, then the sprite palette is not transparent. In other
-            // words, a sprite has been found
-            if (spritePaletteLower) {
-                foundSprite = true;
-                break;
-            }
+    // The sprite line already has the first non-transparent sprite on the current pixel, if any
+    const uint8_t spritePixel = op.spriteLine[op.pixel];
+    const uint8_t spritePalette = spritePixel & 0xf;
+    const bool foundSprite = spritePixel != 0;
+    const bool isSprite0 = spritePixel & PPUOp::Sprite0Flag;
+    // Sprite 0 hit is the only part that affects anything other than the frame. Its own conditions
+    // cover the cases where the branches below don't check for it
+    if (!frameOutput) {
+        if (foundSprite && areSpritesShown()) {
+            setSprite0Hit(isSprite0, bgPalette);
         }
+        return;
     }
 
     bool spriteChosen = false;
-    if (foundSprite) {
-        // Determine whether to output the background pixel or the sprite pixel
-        spriteChosen = spriteIterator->isChosen(bgPaletteLower, spritePaletteLower);
+    // Determine whether to output the background pixel or the sprite pixel. The conditions are
+    // based on this priority multiplexer decision table:
+    // https://www.nesdev.org/wiki/PPU_rendering#Preface. Only the lower 2 bits of color are
+    // relevant
+    if (foundSprite && (!bgPaletteLower || !(spritePixel & PPUOp::BehindBGFlag))) {
+        spriteChosen = true;
     }
 
     uint8_t paletteEntry = 0;
@@ -533,12 +721,12 @@ void PPU::setPixel(MMC& mmc) {
         const uint16_t spritePaletteStart = 0x3f10;
         // Output the sprite pixel
         paletteEntry = readVRAM(spritePaletteStart + spritePalette, mmc);
-        setSprite0Hit(*spriteIterator, bgPalette);
+        setSprite0Hit(isSprite0, bgPalette);
     } else if (isBGShown() && (op.pixel > 7 || isBGLeftColShown())) {
         // Output the background pixel
         paletteEntry = readVRAM(paletteStart + bgPalette, mmc);
         if (foundSprite && areSpritesShown()) {
-            setSprite0Hit(*spriteIterator, bgPalette);
+            setSprite0Hit(isSprite0, bgPalette);
         }
     } else if (!isRenderingEnabled() && mirroredV >= paletteStart && mirroredV <= paletteEnd) {
         // Output the current VRAM address:
@@ -549,53 +737,301 @@ void PPU::setPixel(MMC& mmc) {
         // https://www.nesdev.org/wiki/PPU_palettes#Memory_Map
         paletteEntry = readVRAM(paletteStart, mmc);
     }
-    setRGB(paletteEntry);
+    setPaletteEntry(paletteEntry);
 }
 
 // Sets the sprite 0 hit flag in the PPUSTATUS register:
 // https://www.nesdev.org/wiki/PPU_OAM#Sprite_zero_hits
 
-void PPU::setSprite0Hit(const Sprite& sprite, const uint8_t bgPalette) {
-    if (sprite.spriteNum == 0 && bgPalette && isBGShown() && op.pixel != 255 &&
+void PPU::setSprite0Hit(const bool isSprite0, const uint8_t bgPalette) {
+    if (isSprite0 && bgPalette && isBGShown() && op.pixel != 255 &&
             (op.pixel > 7 || (isBGLeftColShown() && areSpritesLeftColShown()))) {
-        registers[PPUStatus] |= 0x40;
+        // The scanline renderer outputs the pixel early, so it sets the flag later on the cycle
+        // that the pixel would've been output on instead
+        if (renderMode == ScanlineRendering) {
+            const unsigned int firstPixelOutputCycle = 4;
+            if (op.sprite0HitCycle == 0) {
+                op.sprite0HitCycle = firstPixelOutputCycle + op.pixel;
+            }
+        } else {
+            registers[PPUStatus] |= 0x40;
+        }
+    }
+}
+
+// Sets the current pixel's palette entry in the frame. Palette RAM is only 6 bits wide, so the
+// upper 2 bits are ignored
+
+void PPU::setPaletteEntry(const uint8_t paletteEntry) {
+    const unsigned int frameWidth = 256;
+    framePaletteEntries[op.pixel + op.scanline * frameWidth] = paletteEntry & 0x3f;
+}
+
+// Converts the frame into ARGB values in the frame memory unless the output is turned off
+
+void PPU::renderFrame() {
+    if (!frameOutput) {
+        return;
+    }
+    if (framePixels == nullptr) {
+        convertFrame(frame, framePitch);
+    } else {
+        convertFrame(framePixels, framePitch);
+    }
+}
+
+// Returns how many lines of framePaletteEntries the current frame has output so far, including the
+// line that's being output. 0 outside of the visible scanlines and once the frame has been rendered
+
+unsigned int PPU::getOutputLineCount() const {
+    const unsigned int lastRenderLine = 239;
+    const unsigned int lastPixelOutputCycle = 4 + 255;
+    if (op.scanline > lastRenderLine || (op.scanline == lastRenderLine && op.cycle >
+            lastPixelOutputCycle)) {
+        return 0;
+    }
+    return op.scanline + 1;
+}
+
+// Converts the palette entries of the frame into ARGB values in one pass and writes them to pixels,
+// which holds 240 rows of 256 pixels that are pitch bytes apart. Each scanline looks its palette
+// entries up in the colors for its color mode, so grayscale and color emphasis don't cost anything
+// extra per pixel. Uses AVX2 gathers if the host CPU supports them
+
+void PPU::convertFrame(uint32_t* pixels, const unsigned int pitch) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        convertFrameAVX2(pixels, pitch);
+        return;
+    }
+#endif
+    const unsigned int frameWidth = 256;
+    const unsigned int frameHeight = 240;
+    for (unsigned int line = 0; line < frameHeight; ++line) {
+        const uint32_t* lineColors = colors[lineColorModes[line]];
+        const uint8_t* paletteEntries = framePaletteEntries + line * frameWidth;
+        uint32_t* linePixels = (uint32_t*) ((uint8_t*) pixels + line * pitch);
+        for (unsigned int i = 0; i < frameWidth; ++i) {
+            linePixels[i] = lineColors[paletteEntries[i]];
+        }
     }
 }
 
-// Sets the current pixel's RGB values in the frame
+#if defined(__x86_64__) || defined(__i386__)
+// Same as convertFrame, but converts 8 pixels at a time. Only this function is compiled for AVX2,
+// so the rest of the emulator still runs on CPUs without it
 
-void PPU::setRGB(const uint8_t paletteEntry) {
+__attribute__((target("avx2"))) void PPU::convertFrameAVX2(uint32_t* pixels,
+        const unsigned int pitch) {
     const unsigned int frameWidth = 256;
-    // Each 4 bytes in the frame is a pixel. The first byte is the blue value, the second is the
-    // green value, the third is the red value, and the fourth is the opacity
-    const unsigned int blueIndex = (op.pixel + op.scanline * frameWidth) * 4;
-    const unsigned int greenIndex = blueIndex + 1;
-    const unsigned int redIndex = blueIndex + 2;
-    frame[redIndex] = palette[paletteEntry].red;
-    frame[greenIndex] = palette[paletteEntry].green;
-    frame[blueIndex] = palette[paletteEntry].blue;
-    frame[blueIndex + 3] = SDL_ALPHA_OPAQUE;
-}
-
-// Renders a frame via SDL
-
-void PPU::renderFrame(SDL_Renderer* renderer, SDL_Texture* texture) {
-    if (renderer != nullptr && texture != nullptr) {
-        SDL_RenderClear(renderer);
-        uint8_t* lockedPixels = nullptr;
-        int pitch = 0;
-        SDL_LockTexture(texture, nullptr, (void**) &lockedPixels, &pitch);
-        const unsigned int frameWidth = 256;
-        const unsigned int frameHeight = 240;
-        const unsigned int bytesPerPixel = 4;
-        const unsigned int frameSize = frameWidth * frameHeight * bytesPerPixel;
-        std::memcpy(lockedPixels, frame, frameSize);
-        SDL_UnlockTexture(texture);
-        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
-        SDL_RenderPresent(renderer);
+    const unsigned int frameHeight = 240;
+    const unsigned int pixelsPerVector = 8;
+    for (unsigned int line = 0; line < frameHeight; ++line) {
+        const int* lineColors = (const int*) colors[lineColorModes[line]];
+        const uint8_t* paletteEntries = framePaletteEntries + line * frameWidth;
+        uint32_t* linePixels = (uint32_t*) ((uint8_t*) pixels + line * pitch);
+        for (unsigned int i = 0; i < frameWidth; i += pixelsPerVector) {
+            const __m128i entries = _mm_loadl_epi64((const __m128i*) (paletteEntries + i));
+            const __m256i indices = _mm256_cvtepu8_epi32(entries);
+            const __m256i argb = _mm256_i32gather_epi32(lineColors, indices, 4);
+            _mm256_storeu_si256((__m256i*) (linePixels + i), argb);
+        }
+    }
+}
+#endif
+
+// Executes exactly one PPU cycle with the scanline renderer. Sprite evaluation, tile row fetches,
+// and the coarse X increments in the middle of the scanline aren't done cycle by cycle, so the
+// cycles in between the ones handled here don't do anything
+
+void PPU::stepScanline(MMC& mmc) {
+    skipCycle0();
+    const unsigned int lastRenderLine = 239;
+    const unsigned int firstPixelOutputCycle = 4;
+    const unsigned int lastPixelOutputCycle = firstPixelOutputCycle + 255;
+    if (op.scanline <= lastRenderLine) {
+        if (op.cycle == firstPixelOutputCycle) {
+            renderScanline(mmc);
+        }
+        if (op.cycle >= firstPixelOutputCycle && op.cycle == op.sprite0HitCycle) {
+            registers[PPUStatus] |= 0x40;
+        }
+        // Same as the dot renderer, so the frame is rendered on the same cycle in both modes
+        if (op.scanline == lastRenderLine && op.cycle == lastPixelOutputCycle) {
+            renderFrame();
+            frameDone = true;
+        }
+    }
+    if (isRenderingEnabled()) {
+        updateScanlineScroll();
+    }
+    if (op.cycle == 1) {
+        updatePPUStatus(mmc);
+    }
+    op.advanceCycle();
+    ++totalCycles;
+}
+
+// Renders the whole current scanline at once using the scrolling position, registers, and mapper
+// state at that point. The cycle that sprite 0 hit happens on is worked out while rendering
+
+void PPU::renderScanline(MMC& mmc) {
+    const unsigned int tileRowSize = 8;
+    const unsigned int tilesPerRow = 32;
+    // One more tile row than fits in the scanline is needed when the fine X scroll is nonzero
+    const unsigned int tileRowsPerScanline = tilesPerRow + 1;
+    const unsigned int nametableSelect = getNametableSelect();
+    // Coarse X scroll across both horizontally adjacent nametables (0 - 63). v is already 2 tile
+    // rows ahead, since the 2 tile rows for the start of the scanline are fetched on the previous
+    // scanline
+    const unsigned int coarseX = getCoarseXScroll() + (nametableSelect & 1) * tilesPerRow;
+    const unsigned int firstTile = coarseX + tilesPerRow * 2 - 2;
+    const unsigned int coarseYScroll = getCoarseYScroll();
+    const uint16_t patternAddr = getBGPatternAddr() + getFineYScroll();
+    uint8_t bgPalettes[tileRowsPerScanline * tileRowSize];
+    for (unsigned int i = 0; i < tileRowsPerScanline; ++i) {
+        const unsigned int tile = (firstTile + i) % (tilesPerRow * 2);
+        const unsigned int coarseXScroll = tile % tilesPerRow;
+        const uint16_t nametableStart = 0x2000;
+        const uint16_t nametableMirrorSize = 0x400;
+        const uint16_t nametableBaseAddr = nametableStart + ((nametableSelect & 2) | tile /
+            tilesPerRow) * nametableMirrorSize;
+        const uint8_t nametableEntry = readVRAM(nametableBaseAddr + coarseXScroll + coarseYScroll *
+            tilesPerRow, mmc);
+        // Same as updateAttribute, where each attribute entry covers 4x4 tiles
+        const unsigned int attributeOffset = 0x3c0;
+        const uint8_t attributeEntry = readVRAM(nametableBaseAddr + attributeOffset + coarseXScroll
+            / 4 + coarseYScroll / 4 * tilesPerRow / 4, mmc);
+        // The quadrant's 2 bits are shifted by 2 if it's on the right and by 4 if it's on the
+        // bottom
+        const unsigned int shiftNum = (coarseXScroll & 2) + (coarseYScroll & 2) * 2;
+        const uint8_t upperPaletteBits = ((attributeEntry >> shiftNum) & 3) << 2;
+        const uint16_t addr = nametableEntry * 0x10 + patternAddr;
+        const uint64_t tileRow = PatternDecoder::decode(readVRAM(addr, mmc), readVRAM(addr + 8,
+            mmc));
+        for (unsigned int j = 0; j < tileRowSize; ++j) {
+            bgPalettes[i * tileRowSize + j] = ((tileRow >> (j * 8)) & 3) | upperPaletteBits;
+        }
+    }
+
+    if (frameOutput) {
+        lineColorModes[op.scanline] = getColorMode();
+    }
+    op.sprite0HitCycle = 0;
+    // Same as the dot renderer, there are no sprites on scanline 0
+    if (op.scanline > 0 && isRenderingEnabled()) {
+        evaluateScanlineSprites(mmc);
+    }
+    op.loadSpriteLine();
+    const unsigned int pixelsPerScanline = 256;
+    for (op.pixel = 0; op.pixel < pixelsPerScanline; ++op.pixel) {
+        setPixel(bgPalettes[op.pixel + x], mmc);
+    }
+    op.pixel = 0;
+}
+
+// Finds at most 8 sprites that are in range of the current scanline and fetches their pattern
+// entries in one go, which are then pre-rendered into the sprite line. Like the dot renderer,
+// sprites are evaluated and fetched as if it's still the previous scanline
+
+void PPU::evaluateScanlineSprites(MMC& mmc) {
+    const unsigned int evaluatedLine = op.scanline - 1;
+    const unsigned int spriteHeight = getSpriteHeight();
+    const unsigned int spriteCount = 64;
+    const unsigned int maxSpritesPerScanline = 8;
+    for (unsigned int i = 0; i < spriteCount && op.nextSprites.size() < maxSpritesPerScanline;
+            ++i) {
+        Sprite sprite(oam[i * 4], i);
+        if (sprite.isYInRange(evaluatedLine, spriteHeight)) {
+            sprite.tileIndexNum = oam[i * 4 + 1];
+            sprite.attributes = oam[i * 4 + 2];
+            sprite.xPos = oam[i * 4 + 3];
+            const uint16_t addr = getSpriteTileRowAddr(sprite, evaluatedLine);
+            sprite.patternEntryLo = readVRAM(addr, mmc);
+            sprite.patternEntryHi = readVRAM(addr + 8, mmc);
+            op.nextSprites.push_back(sprite);
+        }
     }
 }
 
+// Updates the scrolling position in the v register on the same cycles as updateScroll. The coarse X
+// increments from fetching the scanline's tile rows are done all at once before the Y increment
+
+void PPU::updateScanlineScroll() {
+    const unsigned int lastRenderLine = 239;
+    const unsigned int prerenderLine = 261;
+    if (op.cycle == 256 && op.scanline <= lastRenderLine) {
+        const unsigned int tileRowsFetched = 31;
+        for (unsigned int i = 0; i < tileRowsFetched; ++i) {
+            incrementCoarseXScroll();
+        }
+        incrementYScroll();
+    } else if (op.cycle == 257 && (op.scanline <= lastRenderLine || op.scanline == prerenderLine)) {
+        setCoarseXScroll(getTempCoarseXScroll());
+        resetHorizontalNametable();
+    } else if (op.cycle >= 280 && op.cycle <= 304 && op.scanline == prerenderLine) {
+        setCoarseYScroll(getTempCoarseYScroll());
+        setFineYScroll(getTempFineYScroll());
+        setNametableSelect(getTempNametableSelect());
+    // The 2 tile rows for the start of the next scanline
+    } else if ((op.cycle == 328 || op.cycle == 336) && (op.scanline < lastRenderLine ||
+            op.scanline == prerenderLine)) {
+        incrementCoarseXScroll();
+    }
+}
+
+// Returns the first cycle of the current scanline, starting from the current cycle, that
+// stepScanline has to run on. Every cycle before it only moves on to the next cycle, so runCycles
+// skips them. Cycles 0 and 1 are always run because of skipCycle0 and updatePPUStatus, and the last
+// cycle is always run to move on to the next scanline
+
+unsigned int PPU::getNextScanlineEventCycle() const {
+    const unsigned int lastRenderLine = 239;
+    const unsigned int prerenderLine = 261;
+    const unsigned int lastCycle = 340;
+    if (op.cycle <= 1) {
+        return op.cycle;
+    }
+    unsigned int nextCycle = lastCycle;
+    if (op.scanline <= lastRenderLine) {
+        const unsigned int eventCycles[] = {4, 256, 257, 259, 328, 336};
+        for (const unsigned int eventCycle : eventCycles) {
+            if (eventCycle >= op.cycle) {
+                nextCycle = eventCycle;
+                break;
+            }
+        }
+        if (op.sprite0HitCycle >= op.cycle && op.sprite0HitCycle < nextCycle) {
+            nextCycle = op.sprite0HitCycle;
+        }
+    } else if (op.scanline == prerenderLine) {
+        // The vertical scrolling position is copied on every cycle from 280 to 304
+        const unsigned int eventCycles[] = {3, 257, 280, 281, 282, 283, 284, 285, 286, 287, 288,
+            289, 290, 291, 292, 293, 294, 295, 296, 297, 298, 299, 300, 301, 302, 303, 304, 328,
+            336};
+        for (const unsigned int eventCycle : eventCycles) {
+            if (eventCycle >= op.cycle) {
+                nextCycle = eventCycle;
+                break;
+            }
+        }
+    }
+    return nextCycle;
+}
+
+// Switches to the next render mode on the pre-render line. The scanline renderer doesn't keep the
+// dot renderer's fetch and sprite state up to date, so it's reset to what the dot renderer always
+// leaves it as by the pre-render line
+
+void PPU::switchRenderMode() {
+    renderMode = nextRenderMode;
+    op.status = PPUOp::FetchNametableEntry;
+    op.pixel = 0;
+    op.spriteNum = 0;
+    op.oamEntryNum = 0;
+    op.nextSprites.clear();
+}
+
 // Updates the current scrolling position in the v register if necessary
 
 void PPU::updateScroll() {
@@ -1061,6 +1497,12 @@ bool PPU::isBlueEmphasized() const {
     return registers[PPUMask] & 0x80;
 }
 
+// Packs the grayscale bit and the 3 color emphasis bits of PPUMASK into a color mode (0 - 0xf)
+
+unsigned int PPU::getColorMode() const {
+    return (registers[PPUMask] & 1) | ((registers[PPUMask] >> 4) & 0xe);
+}
+
 bool PPU::isSpriteOverflow() const {
     return registers[PPUStatus] & 0x20;
 }
@@ -1213,4 +1655,42 @@ void PPU::initializePalette() {
     palette[0x3d] = {0x00, 0x00, 0x00};
     palette[0x3e] = {0x00, 0x00, 0x00};
     palette[0x3f] = {0x00, 0x00, 0x00};
+}
+
+// Initializes the ARGB values of each palette entry for each color mode. Grayscale keeps only the
+// brightness bits of the palette entry, and each color emphasis bit darkens the other two color
+// channels: https://www.nesdev.org/wiki/PPU_registers#Color_effects
+
+void PPU::initializeColors() {
+    const unsigned int colorModes = 0x10;
+    const unsigned int paletteSize = 0x40;
+    // Approximate factor that emphasis darkens a color channel by:
+    // https://www.nesdev.org/wiki/NTSC_video#Color_Tint_Bits
+    const double attenuation = 0.816328;
+    const unsigned int redEmphasis = 2;
+    const unsigned int greenEmphasis = 4;
+    const unsigned int blueEmphasis = 8;
+    const uint32_t opaque = 0xff;
+    for (unsigned int mode = 0; mode < colorModes; ++mode) {
+        for (unsigned int entry = 0; entry < paletteSize; ++entry) {
+            unsigned int paletteEntry = entry;
+            if (mode & 1) {
+                paletteEntry &= 0x30;
+            }
+            double red = palette[paletteEntry].red;
+            double green = palette[paletteEntry].green;
+            double blue = palette[paletteEntry].blue;
+            if (mode & (greenEmphasis | blueEmphasis)) {
+                red *= attenuation;
+            }
+            if (mode & (redEmphasis | blueEmphasis)) {
+                green *= attenuation;
+            }
+            if (mode & (redEmphasis | greenEmphasis)) {
+                blue *= attenuation;
+            }
+            colors[mode][entry] = (opaque << 24) | ((uint32_t) red << 16) |
+                ((uint32_t) green << 8) | (uint32_t) blue;
+        }
+    }
 }
\ No newline at end of file
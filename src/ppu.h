@@ -4,9 +4,12 @@
 #pragma once
 class MMC;
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
-#include <SDL.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 #include "mmc.h"
 #include "ppu-op.h"
@@ -20,7 +23,8 @@ class PPU {
     public:
         PPU();
         void clear();
-        void step(MMC& mmc, SDL_Renderer* renderer, SDL_Texture* texture, const bool mute);
+        void step(MMC& mmc, const bool mute);
+        bool runCycles(const unsigned int cycles, MMC& mmc, const bool mute);
 
         // Read/Write I/O Functions
         uint8_t readRegister(const uint16_t addr, MMC& mmc);
@@ -29,10 +33,30 @@ class PPU {
 
         // Miscellaneous Functions
         bool isNMIActive(MMC& mmc, const bool mute);
+        bool isNMIPossible(const unsigned int cycles) const;
+        unsigned int getCyclesUntilFrameEnd() const;
         unsigned int getTotalCycles() const;
+        const uint32_t* getFrameBuffer() const;
         void clearTotalCycles();
+        void saveState(StateWriter& writer) const;
+        bool loadState(StateReader& reader);
         void print(const bool isCycleDone) const;
 
+        // Ways for the PPU to output the background and sprites
+        enum RenderMode {
+            // Fetches tile rows and outputs pixels on the cycles that the PPU does them on
+            DotRendering,
+            // Outputs a whole scanline at once on its first pixel output cycle. Faster, but changes
+            // to the registers, scrolling position, or mapper in the middle of a scanline only take
+            // effect on the next scanline
+            ScanlineRendering
+        };
+
+        // Setters
+        void setRenderMode(const unsigned int mode);
+        void setFrameBuffer(uint32_t* pixels, const unsigned int pitch);
+        void setFrameOutput(const bool output);
+
     private:
         struct RGBVal {
             uint8_t red;
@@ -72,12 +96,28 @@ class PPU {
         // $ffff in the PPU memory map. Doesn't include the pattern tables in the MMC, which are
         // $0000 - $1fff
         uint8_t vram[0x400 + 0x400 + 0x20];
-        // Frame that SDL displays to the screen. Each 4 bytes is a pixel. The first byte is the
-        // blue value, the second is the green value, the third is the red value, and the fourth is
-        // the opacity
-        uint8_t frame[256 * 240 * 4];
+        // Frame where each pixel is a 32-bit ARGB value, which matches SDL_PIXELFORMAT_ARGB8888.
+        // Used if no frame memory was supplied with setFrameBuffer
+        uint32_t frame[256 * 240];
+        // Frame memory that framePaletteEntries is converted into at the end of every frame, which
+        // is owned by the caller (e.g., a locked texture). nullptr if it's frame, so that a copy of
+        // the PPU converts into its own frame instead of the original's
+        uint32_t* framePixels;
+        // Number of bytes from the start of one row of framePixels to the start of the next
+        unsigned int framePitch;
+        // Set to false to skip resolving the color of each pixel and converting finished frames
+        // into the frame memory, e.g., for frames that are run but never displayed
+        bool frameOutput;
+        // Palette entry (0 - 0x3f) of each pixel in the current frame
+        uint8_t framePaletteEntries[256 * 240];
+        // Color mode of each scanline in the current frame, taken from PPUMASK when the scanline
+        // starts being output. Bit 0 is the grayscale bit and bits 1 - 3 are the red, green, and
+        // blue color emphasis bits
+        uint8_t lineColorModes[240];
         // Palette that contains the RGB values for displaying pixel colors
         struct RGBVal palette[0x40];
+        // ARGB value of each palette entry for each of the 16 color modes
+        uint32_t colors[0x10][0x40];
         // PPUDATA read buffer:
         // https://www.nesdev.org/wiki/PPU_registers#The_PPUDATA_read_buffer_(post-fetch)
         uint8_t ppuDataBuffer;
@@ -85,9 +125,17 @@ class PPU {
         PPUOp op;
         // Total number of cycles since initialization
         unsigned int totalCycles;
+        // Set to true when the frame is rendered. Cleared at the start of every call to runCycles
+        bool frameDone;
+        // Depends on enum RenderMode
+        unsigned int renderMode;
+        // Render mode to switch to once the PPU reaches the pre-render line, which is the only
+        // point where neither renderer is partway through a frame
+        unsigned int nextRenderMode;
 
         // Cycle Skipping
         void skipCycle0();
+        unsigned int getCyclesUntil(const unsigned int scanline, const unsigned int cycle) const;
 
         // Fetching
         void fetch(MMC& mmc);
@@ -95,16 +143,30 @@ class PPU {
         uint16_t getNametableSelectAddr() const;
         void updateAttribute();
         void fetchSpriteEntry(MMC& mmc);
+        uint16_t getSpriteTileRowAddr(const Sprite& sprite, const unsigned int scanline) const;
 
         // Sprite Computation
         void clearSecondaryOAM();
         void evaluateSprites();
 
         // Rendering
-        void setPixel(MMC& mmc);
-        void setSprite0Hit(const Sprite& sprite, const uint8_t bgPalette);
-        void setRGB(const uint8_t paletteEntry);
-        void renderFrame(SDL_Renderer* renderer, SDL_Texture* texture);
+        void setPixel(const uint8_t bgPalette, MMC& mmc);
+        void setSprite0Hit(const bool isSprite0, const uint8_t bgPalette);
+        void setPaletteEntry(const uint8_t paletteEntry);
+        void renderFrame();
+        unsigned int getOutputLineCount() const;
+        void convertFrame(uint32_t* pixels, const unsigned int pitch);
+#if defined(__x86_64__) || defined(__i386__)
+        void convertFrameAVX2(uint32_t* pixels, const unsigned int pitch);
+#endif
+
+        // Scanline Rendering
+        void stepScanline(MMC& mmc);
+        void renderScanline(MMC& mmc);
+        void evaluateScanlineSprites(MMC& mmc);
+        void updateScanlineScroll();
+        unsigned int getNextScanlineEventCycle() const;
+        void switchRenderMode();
 
         // Scrolling
         void updateScroll();
@@ -149,6 +211,7 @@ class PPU {
         bool isRedEmphasized() const;
         bool isGreenEmphasized() const;
         bool isBlueEmphasized() const;
+        unsigned int getColorMode() const;
         bool isSpriteOverflow() const;
         bool isSpriteZeroHit() const;
         bool isVblank() const;
@@ -173,6 +236,7 @@ class PPU {
 
         // Color Palette Initialization
         void initializePalette();
+        void initializeColors();
 
         // Register Indices
         enum RegisterIndex {
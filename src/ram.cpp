@@ -58,6 +58,27 @@ uint8_t RAM::pull(uint8_t& pointer, const bool mute) {
     return val;
 }
 
+// Returns a pointer to where the 256-byte page of the CPU memory map with the given page number
+// (i.e., the high byte of the address) is stored, so that the CPU can access it directly
+
+uint8_t* RAM::getPage(const uint8_t page) {
+    return data + getLocalAddr(page << 8);
+}
+
+// Returns all 2 KB of the RAM without mirroring
+
+const uint8_t* RAM::getData() const {
+    return data;
+}
+
+void RAM::saveState(StateWriter& writer) const {
+    writer.write(data);
+}
+
+void RAM::loadState(StateReader& reader) {
+    reader.read(data);
+}
+
 // Private Member Functions
 
 // Maps the CPU address to the RAM's local field, data
@@ -5,6 +5,8 @@
 #include <cstring>
 #include <iostream>
 
+#include "save-state.h"
+
 // Random Access Memory
 // The main workspace for programs. Stores data for addresses $0000 - $00ff (zero page), $0100 -
 // $01ff (stack), $0200 - $07ff (additional RAM), and $0800 - $1fff (mirrored addresses) in the CPU
@@ -18,6 +20,10 @@ class RAM {
         void write(const uint16_t addr, const uint8_t val);
         void push(uint8_t& pointer, const uint8_t val, const bool mute);
         uint8_t pull(uint8_t& pointer, const bool mute);
+        uint8_t* getPage(const uint8_t page);
+        const uint8_t* getData() const;
+        void saveState(StateWriter& writer) const;
+        void loadState(StateReader& reader);
 
     private:
         uint8_t data[0x800]; // RAM in the CPU memory map
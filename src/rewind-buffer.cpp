@@ -0,0 +1,237 @@
+#include "rewind-buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Public Member Functions
+
+// capacity is the most frames that the buffer holds. A delta only stays small while the state is
+// close to its keyframe, so keyframeInterval trades the size of the keyframes for the size of the
+// deltas
+
+RewindBuffer::RewindBuffer(const unsigned int capacity, const unsigned int keyframeInterval) :
+        snapshots(std::max(capacity, 1u)),
+        keyframeInterval(std::max(keyframeInterval, 1u)),
+        first(0),
+        frameCount(0),
+        keyframeCount(0),
+        encodedBytes(0),
+        keyframeFrames(0) {}
+
+// Saves the state of the machine as the newest frame. Drops the oldest frames if the buffer is full
+
+void RewindBuffer::push(NESCore& core) {
+    core.saveState(state);
+    if (frameCount == snapshots.size()) {
+        dropOldestKeyframe();
+    }
+    // The state only changes size if it was saved in the middle of a frame, in which case it can't
+    // be XORed with the keyframe
+    const bool keyframe = frameCount == 0 || keyframeFrames >= keyframeInterval ||
+        state.size() != keyframeState.size();
+    if (keyframe) {
+        if (zeroState.size() < state.size()) {
+            zeroState.resize(state.size(), 0);
+        }
+        encode(state, zeroState.data());
+        keyframeState.assign(state.begin(), state.end());
+        keyframeFrames = 1;
+        ++keyframeCount;
+    } else {
+        encode(state, keyframeState.data());
+        ++keyframeFrames;
+    }
+
+    // The encoded state is copied into a vector of its own size instead of reusing the snapshot's
+    // old vector, which could be the size of a keyframe
+    struct Snapshot& snapshot = snapshots[getIndex(frameCount)];
+    snapshot.data = std::vector<uint8_t>(encodedState.begin(), encodedState.end());
+    snapshot.stateSize = state.size();
+    snapshot.keyframe = keyframe;
+    encodedBytes += snapshot.data.size();
+    ++frameCount;
+}
+
+// Drops the newest frames and loads the newest one that's left, which puts the machine back to
+// where it was that many frames ago. 0 frames reloads the newest frame. Returns false without
+// changing anything if the buffer doesn't go back that far or the machine can't load the state
+// (e.g., a different ROM was loaded since it was pushed)
+
+bool RewindBuffer::rewind(NESCore& core, const unsigned int frames) {
+    if (frames >= frameCount) {
+        return false;
+    }
+    // The keyframe is decoded even if the frame is a delta, since the next frame that's pushed is
+    // encoded against it
+    const unsigned int target = frameCount - 1 - frames;
+    const unsigned int keyframe = findKeyframe(target);
+    decode(snapshots[getIndex(keyframe)], zeroState.data(), keyframeState);
+    bool loaded;
+    if (keyframe == target) {
+        loaded = core.loadState(keyframeState.data(), keyframeState.size());
+    } else {
+        decode(snapshots[getIndex(target)], keyframeState.data(), state);
+        loaded = core.loadState(state.data(), state.size());
+    }
+    if (!loaded) {
+        // Go back to the keyframe that the newest frame is encoded against
+        decode(snapshots[getIndex(findKeyframe(frameCount - 1))], zeroState.data(),
+            keyframeState);
+        return false;
+    }
+
+    for (unsigned int i = 0; i < frames; ++i) {
+        struct Snapshot& snapshot = snapshots[getIndex(frameCount - 1)];
+        encodedBytes -= snapshot.data.size();
+        if (snapshot.keyframe) {
+            --keyframeCount;
+        }
+        snapshot.data = std::vector<uint8_t>();
+        --frameCount;
+    }
+    keyframeFrames = target - keyframe + 1;
+    return true;
+}
+
+void RewindBuffer::clear() {
+    for (struct Snapshot& snapshot : snapshots) {
+        snapshot.data = std::vector<uint8_t>();
+    }
+    first = 0;
+    frameCount = 0;
+    keyframeCount = 0;
+    encodedBytes = 0;
+    keyframeFrames = 0;
+}
+
+unsigned int RewindBuffer::getFrameCount() const {
+    return frameCount;
+}
+
+unsigned int RewindBuffer::getKeyframeCount() const {
+    return keyframeCount;
+}
+
+// Returns the number of bytes that the encoded frames and the buffers for encoding them take up
+
+size_t RewindBuffer::getMemoryUsage() const {
+    return encodedBytes + snapshots.size() * sizeof(struct Snapshot) + keyframeState.capacity() +
+        state.capacity() + encodedState.capacity() + zeroState.capacity();
+}
+
+// Private Member Functions
+
+// Converts the age of a frame (0 is the oldest frame) into its index in snapshots
+
+unsigned int RewindBuffer::getIndex(const unsigned int snapshot) const {
+    return (first + snapshot) % snapshots.size();
+}
+
+// Returns the age of the keyframe that the given frame is encoded against. The oldest frame is
+// always a keyframe
+
+unsigned int RewindBuffer::findKeyframe(const unsigned int snapshot) const {
+    unsigned int keyframe = snapshot;
+    while (!snapshots[getIndex(keyframe)].keyframe) {
+        --keyframe;
+    }
+    return keyframe;
+}
+
+// Drops the oldest keyframe and the deltas against it, since they can't be decoded without it
+
+void RewindBuffer::dropOldestKeyframe() {
+    do {
+        struct Snapshot& snapshot = snapshots[first];
+        encodedBytes -= snapshot.data.size();
+        if (snapshot.keyframe) {
+            --keyframeCount;
+        }
+        snapshot.data = std::vector<uint8_t>();
+        first = (first + 1) % snapshots.size();
+        --frameCount;
+    } while (frameCount != 0 && !snapshots[first].keyframe);
+}
+
+// Encodes the state XORed with the reference into encodedState. The encoding is a sequence of runs,
+// each of which is the number of bytes that are the same as the reference, the number of bytes
+// that are different, and then the XORs of the different bytes
+
+void RewindBuffer::encode(const std::vector<uint8_t>& state, const uint8_t* reference) {
+    encodedState.clear();
+    const uint8_t* data = state.data();
+    const size_t size = state.size();
+    size_t position = 0;
+    while (position < size) {
+        const size_t sameStart = position;
+        // Most of the state is the same as the reference, so it's compared 8 bytes at a time first
+        uint64_t word;
+        uint64_t referenceWord;
+        while (position + sizeof(word) <= size) {
+            memcpy(&word, data + position, sizeof(word));
+            memcpy(&referenceWord, reference + position, sizeof(word));
+            if (word != referenceWord) {
+                break;
+            }
+            position += sizeof(word);
+        }
+        while (position < size && data[position] == reference[position]) {
+            ++position;
+        }
+        const size_t differentStart = position;
+        while (position < size && data[position] != reference[position]) {
+            ++position;
+        }
+        writeLength(differentStart - sameStart);
+        writeLength(position - differentStart);
+        for (size_t i = differentStart; i < position; ++i) {
+            encodedState.push_back(data[i] ^ reference[i]);
+        }
+    }
+}
+
+// Decodes a snapshot that was encoded against the reference
+
+void RewindBuffer::decode(const struct Snapshot& snapshot, const uint8_t* reference,
+        std::vector<uint8_t>& state) const {
+    state.resize(snapshot.stateSize);
+    size_t position = 0;
+    size_t offset = 0;
+    while (offset < snapshot.stateSize) {
+        const size_t sameLength = readLength(snapshot.data, position);
+        const size_t differentLength = readLength(snapshot.data, position);
+        memcpy(state.data() + offset, reference + offset, sameLength);
+        offset += sameLength;
+        for (size_t i = 0; i < differentLength; ++i) {
+            state[offset] = reference[offset] ^ snapshot.data[position];
+            ++offset;
+            ++position;
+        }
+    }
+}
+
+// Appends a length to encodedState, 7 bits at a time starting with the least significant bits. The
+// top bit of each byte is set if there are more bytes after it
+
+void RewindBuffer::writeLength(size_t length) {
+    const uint8_t moreBytes = 0x80;
+    while (length >= moreBytes) {
+        encodedState.push_back((length & 0x7f) | moreBytes);
+        length >>= 7;
+    }
+    encodedState.push_back(length);
+}
+
+size_t RewindBuffer::readLength(const std::vector<uint8_t>& data, size_t& position) const {
+    const uint8_t moreBytes = 0x80;
+    size_t length = 0;
+    unsigned int shift = 0;
+    while (data[position] & moreBytes) {
+        length |= (size_t) (data[position] & 0x7f) << shift;
+        shift += 7;
+        ++position;
+    }
+    length |= (size_t) data[position] << shift;
+    ++position;
+    return length;
+}
@@ -0,0 +1,71 @@
+#ifndef REWINDBUFFER_H
+#define REWINDBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "nes-core.h"
+
+// Rewind Buffer
+// Ring buffer of save states, one for the end of every frame, for rewinding the machine a frame at
+// a time. Every keyframeInterval frames the state is stored as a keyframe, and the states in
+// between are stored as deltas against the keyframe before them. Consecutive states are nearly
+// identical (most of the RAM, VRAM, OAM, and PRG-RAM stays the same from one frame to the next), so
+// a delta is the state XORed with the keyframe, where the runs of zeros are run-length encoded.
+// Keyframes are encoded the same way against a state of all zeros. Once the buffer is full, the
+// oldest keyframe is dropped along with all of the deltas against it, so the buffer holds between
+// capacity - keyframeInterval and capacity frames
+
+class RewindBuffer {
+    public:
+        RewindBuffer(const unsigned int capacity, const unsigned int keyframeInterval);
+        void push(NESCore& core);
+        bool rewind(NESCore& core, const unsigned int frames);
+        void clear();
+
+        // Getters
+        unsigned int getFrameCount() const;
+        unsigned int getKeyframeCount() const;
+        size_t getMemoryUsage() const;
+
+    private:
+        struct Snapshot {
+            // The encoded state
+            std::vector<uint8_t> data;
+            // Size of the state before it was encoded
+            size_t stateSize;
+            // Set to true if the state is encoded against zeros instead of a keyframe
+            bool keyframe;
+        };
+
+        std::vector<struct Snapshot> snapshots;
+        unsigned int keyframeInterval;
+        // Index in snapshots of the oldest snapshot
+        unsigned int first;
+        unsigned int frameCount;
+        unsigned int keyframeCount;
+        // Total number of bytes in the encoded states
+        size_t encodedBytes;
+        // Decoded state of the keyframe that the newest snapshot is a part of, which the next
+        // snapshot is encoded against if it isn't a keyframe
+        std::vector<uint8_t> keyframeState;
+        // Number of snapshots from the newest keyframe to the newest snapshot, including both
+        unsigned int keyframeFrames;
+        // Buffers that are reused from frame to frame so that pushing doesn't have to allocate
+        // more than the encoded state itself
+        std::vector<uint8_t> state;
+        std::vector<uint8_t> encodedState;
+        std::vector<uint8_t> zeroState;
+
+        unsigned int getIndex(const unsigned int snapshot) const;
+        unsigned int findKeyframe(const unsigned int snapshot) const;
+        void dropOldestKeyframe();
+        void encode(const std::vector<uint8_t>& state, const uint8_t* reference);
+        void decode(const struct Snapshot& snapshot, const uint8_t* reference,
+            std::vector<uint8_t>& state) const;
+        void writeLength(size_t length);
+        size_t readLength(const std::vector<uint8_t>& data, size_t& position) const;
+};
+
+#endif
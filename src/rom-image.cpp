@@ -0,0 +1,225 @@
+#include "rom-image.h"
+
+#include <climits>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hash.h"
+
+// Public Member Functions
+
+ROMImage::~ROMImage() {
+    if (mapping != nullptr) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+// Copies an .NES file that is already in memory, which is the whole file including the iNES header
+
+std::shared_ptr<const ROMImage> ROMImage::fromMemory(const uint8_t* data, const size_t size,
+        std::string& error) {
+    // The constructor is private, so std::make_shared can't be used
+    std::shared_ptr<ROMImage> image(new ROMImage());
+    image->data.assign(data, data + size);
+    if (!image->parse(image->data.data(), image->data.size(), error)) {
+        return nullptr;
+    }
+    return image;
+}
+
+// Maps an .NES file into memory. The pages are shared with every other process that maps the same
+// file, and only the ones that are actually read get loaded from the disk
+
+std::shared_ptr<const ROMImage> ROMImage::fromFile(const std::string& filename,
+        std::string& error) {
+    std::shared_ptr<ROMImage> image(new ROMImage());
+    const int file = open(filename.c_str(), O_RDONLY);
+    struct stat fileInfo;
+    if (file == -1 || fstat(file, &fileInfo) == -1) {
+        if (file != -1) {
+            close(file);
+        }
+        error = "Error reading in file";
+        return nullptr;
+    }
+    // mmap can't map an empty file, but parse reports that it's too short anyway
+    if (fileInfo.st_size != 0) {
+        void* mapping = mmap(nullptr, fileInfo.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping == MAP_FAILED) {
+            close(file);
+            error = "Error reading in file";
+            return nullptr;
+        }
+        // The destructor unmaps it from here on
+        image->mapping = mapping;
+        image->mappingSize = fileInfo.st_size;
+    }
+    // The mapping stays valid after the file is closed
+    close(file);
+    if (!image->parse((const uint8_t*) image->mapping, image->mappingSize, error)) {
+        return nullptr;
+    }
+    return image;
+}
+
+// Returns the image of zeros that every MMC starts with: 2 PRG banks and 1 CHR bank. There's only
+// one, which all of them share
+
+std::shared_ptr<const ROMImage> ROMImage::getBlankImage() {
+    static const std::shared_ptr<const ROMImage> blankImage = makeBlankImage();
+    return blankImage;
+}
+
+const uint8_t* ROMImage::getPRGROM() const {
+    return prgROM;
+}
+
+const uint8_t* ROMImage::getCHRROM() const {
+    return chrROM;
+}
+
+const struct ROMImage::Header& ROMImage::getHeader() const {
+    return header;
+}
+
+uint32_t ROMImage::getHash() const {
+    return hash;
+}
+
+// Private Member Functions
+
+// Makes an empty image for the static functions to fill in
+
+ROMImage::ROMImage() :
+        mapping(nullptr),
+        mappingSize(0),
+        prgROM(nullptr),
+        chrROM(nullptr),
+        header(),
+        hash(hashStart) { }
+
+std::shared_ptr<const ROMImage> ROMImage::makeBlankImage() {
+    const uint16_t prgBankSize = 0x4000;
+    const uint16_t chrBankSize = 0x2000;
+    std::shared_ptr<ROMImage> image(new ROMImage());
+    image->data.resize(prgBankSize * 2 + chrBankSize, 0);
+    image->prgROM = image->data.data();
+    image->chrROM = image->data.data() + prgBankSize * 2;
+    image->header.prgROMBytes = prgBankSize * 2;
+    image->header.chrROMBytes = chrBankSize;
+    image->hash = hashBytes(image->data.data(), image->data.size(), hashStart);
+    return image;
+}
+
+// Reads the header and finds where the PRG-ROM and CHR-ROM are in the file. Returns false with the
+// reason in error if the file isn't an .NES file, if it's too short to hold everything that the
+// header says it has, or if the sizes can't be mapped by the MMC
+
+bool ROMImage::parse(const uint8_t* file, const size_t size, std::string& error) {
+    const uint8_t headerSize = 0x10;
+    if (size < headerSize) {
+        error = "ROM is too short to have an iNES header";
+        return false;
+    }
+    // Every header starts with "NES" followed by an MS-DOS end-of-file
+    if (file[0] != 'N' || file[1] != 'E' || file[2] != 'S' || file[3] != 0x1a) {
+        error = "ROM doesn't start with an iNES header";
+        return false;
+    }
+
+    // Flags 7 has 0b10 in bits 2 and 3 for NES 2.0:
+    // https://www.nesdev.org/wiki/NES_2.0#Identification
+    header.nes20 = (file[7] & 0xc) == 8;
+    header.verticalMirroring = file[6] & 1;
+    header.battery = file[6] & 2;
+    header.trainer = file[6] & 4;
+    header.fourScreen = file[6] & 8;
+    header.mapperID = (file[6] >> 4) | (file[7] & 0xf0);
+    const uint16_t prgBankSize = 0x4000;
+    const uint16_t chrBankSize = 0x2000;
+    if (header.nes20) {
+        header.prgROMBytes = getNES20ROMBytes(file[4], file[9] & 0xf, prgBankSize);
+        header.chrROMBytes = getNES20ROMBytes(file[5], file[9] >> 4, chrBankSize);
+        header.mapperID |= (file[8] & 0xf) << 8;
+        header.submapperID = file[8] >> 4;
+        header.prgRAMBytes = getNES20RAMBytes(file[10] & 0xf);
+        header.prgNVRAMBytes = getNES20RAMBytes(file[10] >> 4);
+        header.chrRAMBytes = getNES20RAMBytes(file[11] & 0xf);
+        header.chrNVRAMBytes = getNES20RAMBytes(file[11] >> 4);
+        header.timing = file[12] & 3;
+        header.consoleType = file[7] & 3;
+    } else {
+        header.prgROMBytes = file[4] * prgBankSize;
+        header.chrROMBytes = file[5] * chrBankSize;
+        // Some old tools wrote their name into the unused bytes 7 - 15 (e.g., "DiskDude!"), in
+        // which case the upper half of the mapper ID is garbage:
+        // https://www.nesdev.org/wiki/INES#Variant_comparison
+        if (file[12] != 0 || file[13] != 0 || file[14] != 0 || file[15] != 0) {
+            header.mapperID &= 0xf;
+        }
+    }
+    if (header.prgROMBytes == 0) {
+        error = "ROM has no PRG-ROM";
+        return false;
+    }
+
+    const uint16_t trainerSize = 0x200;
+    // Skip over trainer data if there is any
+    size_t offset = headerSize;
+    if (header.trainer) {
+        offset += trainerSize;
+    }
+    // Compared one at a time, since the sizes from a NES 2.0 header can be big enough to overflow
+    // when they're added together
+    if (size < offset || size - offset < header.prgROMBytes ||
+            size - offset - header.prgROMBytes < header.chrROMBytes) {
+        error = "ROM is shorter than its header says";
+        return false;
+    }
+    // The MMC maps the PRG-ROM in 4 KB slots and the CHR-ROM in 1 KB slots, so the last slot of a
+    // NES 2.0 size that isn't a whole number of them would run past the end of the file
+    const uint16_t prgSlotSize = 0x1000;
+    const uint16_t chrSlotSize = 0x400;
+    if (header.prgROMBytes % prgSlotSize != 0 || header.chrROMBytes % chrSlotSize != 0) {
+        error = "ROM has PRG-ROM that isn't a multiple of 4 KB or CHR-ROM that isn't a multiple "
+            "of 1 KB";
+        return false;
+    }
+    prgROM = file + offset;
+    chrROM = file + offset + header.prgROMBytes;
+    // The CHR-ROM comes right after the PRG-ROM, so both are hashed at once
+    hash = hashBytes(prgROM, header.prgROMBytes + header.chrROMBytes, hashStart);
+    return true;
+}
+
+// Returns the size of the PRG-ROM or CHR-ROM in a NES 2.0 header, where the most significant byte
+// is only 4 bits: https://www.nesdev.org/wiki/NES_2.0#PRG-ROM_Area. If those bits are all set, the
+// least significant byte is an exponent (upper 6 bits) and a multiplier (lower 2 bits) instead.
+// Sizes that don't fit in a size_t come out as SIZE_MAX, which no file is long enough to hold
+
+size_t ROMImage::getNES20ROMBytes(const uint8_t lsb, const uint8_t msb,
+        const unsigned int bankSize) const {
+    if (msb != 0xf) {
+        return ((msb << 8) | lsb) * bankSize;
+    }
+    const unsigned int exponent = lsb >> 2;
+    const unsigned int multiplier = (lsb & 3) * 2 + 1;
+    // Anything this big can't be in a file anyway, and it would overflow the shift
+    if (exponent >= sizeof(size_t) * CHAR_BIT - 3) {
+        return SIZE_MAX;
+    }
+    return ((size_t) 1 << exponent) * multiplier;
+}
+
+// Returns the size of a kind of PRG-RAM or CHR-RAM in a NES 2.0 header, which is a shift count:
+// https://www.nesdev.org/wiki/NES_2.0#PRG-(NV)RAM/EEPROM. 0 means that there's none
+
+size_t ROMImage::getNES20RAMBytes(const uint8_t shift) const {
+    if (shift == 0) {
+        return 0;
+    }
+    const unsigned int minimumSize = 64;
+    return minimumSize << shift;
+}
@@ -0,0 +1,97 @@
+#ifndef ROMIMAGE_H
+#define ROMIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ROM Image
+// The contents of an .NES file in either the iNES (https://www.nesdev.org/wiki/INES) or NES 2.0
+// (https://www.nesdev.org/wiki/NES_2.0) format. It never changes once it's loaded, so any number of
+// MMCs can share one image through a std::shared_ptr instead of each keeping its own copy of the
+// PRG-ROM and CHR-ROM. The image is either copied from memory that the caller already has or
+// mapped straight from the file. Either way, the header is parsed once and the PRG-ROM and CHR-ROM
+// are views into the file rather than copies. Images are only made through the static functions,
+// which return nullptr with the reason in error if the file can't be read or isn't a whole .NES
+// file
+
+class ROMImage {
+    public:
+        ~ROMImage();
+        ROMImage(const ROMImage&) = delete;
+        ROMImage& operator=(const ROMImage&) = delete;
+        static std::shared_ptr<const ROMImage> fromMemory(const uint8_t* data, const size_t size,
+            std::string& error);
+        static std::shared_ptr<const ROMImage> fromFile(const std::string& filename,
+            std::string& error);
+        static std::shared_ptr<const ROMImage> getBlankImage();
+
+        // Which TV system the game was made for. Only in NES 2.0 headers
+        enum Timing {
+            NTSC = 0,
+            PAL = 1,
+            MultipleRegion = 2,
+            Dendy = 3
+        };
+
+        // Everything that the header says about the cartridge. The fields that only NES 2.0
+        // headers have are 0 for iNES headers
+        struct Header {
+            // Set to true if the header is in the NES 2.0 format
+            bool nes20;
+            size_t prgROMBytes;
+            size_t chrROMBytes;
+            // Mapper ID which is the type of MMC: https://www.nesdev.org/wiki/Mapper
+            unsigned int mapperID;
+            // Which variant of the mapper: https://www.nesdev.org/wiki/NES_2.0_submappers
+            unsigned int submapperID;
+            // Set to true if the nametables are mirrored vertically instead of horizontally
+            bool verticalMirroring;
+            // Set to true if the cartridge has its own memory for all four nametables
+            bool fourScreen;
+            // Set to true if the cartridge keeps its PRG-RAM or other memory when powered off
+            bool battery;
+            // Set to true if there are 512 bytes of trainer data before the PRG-ROM
+            bool trainer;
+            // Sizes of the PRG-RAM and CHR-RAM, separated into the memory that's lost when the
+            // cartridge is powered off and the memory that's kept by a battery
+            size_t prgRAMBytes;
+            size_t prgNVRAMBytes;
+            size_t chrRAMBytes;
+            size_t chrNVRAMBytes;
+            // Depends on enum Timing
+            unsigned int timing;
+            // Which console the game runs on, such as the NES/Famicom (0) or the Vs. System (1)
+            unsigned int consoleType;
+        };
+
+        // Getters
+        const uint8_t* getPRGROM() const;
+        const uint8_t* getCHRROM() const;
+        const struct Header& getHeader() const;
+        uint32_t getHash() const;
+
+    private:
+        // The whole file if it was copied from memory. Empty if it's mapped
+        std::vector<uint8_t> data;
+        // Where the file is mapped into memory, or nullptr if it was copied
+        void* mapping;
+        size_t mappingSize;
+        // Where the PRG-ROM and CHR-ROM start in the file
+        const uint8_t* prgROM;
+        const uint8_t* chrROM;
+        struct Header header;
+        // FNV-1a hash of the PRG-ROM and CHR-ROM, which tells apart ROMs that have the same header
+        uint32_t hash;
+
+        ROMImage();
+        static std::shared_ptr<const ROMImage> makeBlankImage();
+        bool parse(const uint8_t* file, const size_t size, std::string& error);
+        size_t getNES20ROMBytes(const uint8_t lsb, const uint8_t msb,
+            const unsigned int bankSize) const;
+        size_t getNES20RAMBytes(const uint8_t shift) const;
+};
+
+#endif
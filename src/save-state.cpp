@@ -0,0 +1,54 @@
+#include "save-state.h"
+
+#include <algorithm>
+
+// Public Member Functions
+
+StateWriter::StateWriter(std::vector<uint8_t>& state) : state(state) { }
+
+// Appends size bytes from the field. The field can be nullptr if size is 0, e.g., for an empty
+// std::vector, which memcpy doesn't allow
+
+void StateWriter::write(const void* field, const size_t size) {
+    const size_t end = state.size();
+    state.resize(end + size);
+    std::copy_n((const uint8_t*) field, size, state.data() + end);
+}
+
+StateReader::StateReader(const uint8_t* state, const size_t size) :
+        state(state),
+        size(size),
+        position(0),
+        failed(false) { }
+
+// Copies the next size bytes into the field. Returns false without changing the field if the state
+// is shorter than that or an earlier read already failed. Like write, the field can be nullptr if
+// size is 0
+
+bool StateReader::read(void* field, const size_t size) {
+    if (failed || size > this->size - position) {
+        failed = true;
+        return false;
+    }
+    std::copy_n(state + position, size, (uint8_t*) field);
+    position += size;
+    return true;
+}
+
+// Returns true if every byte of the save state has been read without any read failing
+
+bool StateReader::isDone() const {
+    return !failed && position == size;
+}
+
+// Returns true if a read went past the end of the state
+
+bool StateReader::hasFailed() const {
+    return failed;
+}
+
+// Returns the number of bytes that haven't been read yet
+
+size_t StateReader::getRemainingSize() const {
+    return size - position;
+}
@@ -0,0 +1,62 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Save State
+// A snapshot of the whole machine as one flat block of bytes. Each component writes its fields in
+// a fixed order with a StateWriter and reads them back in the same order with a StateReader. Fields
+// are copied as raw bytes, so a save state can only be loaded by the same version of the emulator
+// on the same kind of machine (i.e., endianness and type sizes), which the version number at the
+// start of the state is for
+
+// Appends fields to the end of a save state
+
+class StateWriter {
+    public:
+        explicit StateWriter(std::vector<uint8_t>& state);
+        void write(const void* field, const size_t size);
+        template <typename T>
+        void write(const T& field);
+
+    private:
+        std::vector<uint8_t>& state;
+};
+
+// Reads fields out of a save state in the order that they were written in. Once a read goes past
+// the end of the state, that read and every read after it leave their fields as they are and fail
+
+class StateReader {
+    public:
+        StateReader(const uint8_t* state, const size_t size);
+        bool read(void* field, const size_t size);
+        template <typename T>
+        bool read(T& field);
+        bool isDone() const;
+        bool hasFailed() const;
+        size_t getRemainingSize() const;
+
+    private:
+        const uint8_t* state;
+        size_t size;
+        // Number of bytes that have been read so far
+        size_t position;
+        // Set to true once a read went past the end of the state
+        bool failed;
+};
+
+// Writes a field that can be copied byte by byte, including arrays of them
+
+template <typename T>
+void StateWriter::write(const T& field) {
+    write(&field, sizeof(field));
+}
+
+template <typename T>
+bool StateReader::read(T& field) {
+    return read(&field, sizeof(field));
+}
+
+#endif
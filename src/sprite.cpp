@@ -70,48 +70,14 @@ uint8_t Sprite::getTileRowIndex(const unsigned int scanline, const unsigned int
     return index;
 }
 
-// Gets the palette for the given pixel, which can be treated as the current x-coordinate that is
-// being rendered
-
-uint8_t Sprite::getPalette(const unsigned int pixel) const {
-    const unsigned int xDiff = getXDifference(pixel);
-    // Gets the furthest left bit in the tile and shifts it right however many times the
-    // x-difference is (i.e., the difference between the pixel and the sprite's x-coordinate), which
-    // will then be the column/bit that the pixel lands on
-    uint8_t pixelBit = 0x80 >> xDiff;
-    const uint8_t upperPaletteBits = getUpperPalette();
-    uint8_t palette = 0;
-    // Perform the above operation in reverse if the sprite is flipped horizontally
-    if (isFlippedHorizontally()) {
-        pixelBit = 1 << xDiff;
-    }
-    if (patternEntryLo & pixelBit) {
-        palette |= 1;
-    }
-    if (patternEntryHi & pixelBit) {
-        palette |= 2;
-    }
-    if (upperPaletteBits & 1) {
-        palette |= 4;
-    }
-    if (upperPaletteBits & 2) {
-        palette |= 8;
-    }
-    return palette;
-}
-
-// Determines whether to "choose" the sprite over the background. The conditions are based on this
-// priority multiplexer decision table: https://www.nesdev.org/wiki/PPU_rendering#Preface. Only the
-// lower 2 bits of color are relevant
+// Decodes the sprite's tile row into the lower 2 bits of the palette for each of its 8 pixels. Each
+// byte is one pixel, where the lowest byte is the leftmost pixel of the sprite after flipping
 
-bool Sprite::isChosen(const uint8_t bgPalette, const uint8_t spritePalette) const {
-    const bool priority = isPrioritized();
-    if (bgPalette && spritePalette && priority) {
-        return true;
-    } else if (!bgPalette && spritePalette) {
-        return true;
+uint64_t Sprite::decodeTileRow() const {
+    if (isFlippedHorizontally()) {
+        return PatternDecoder::decodeFlipped(patternEntryLo, patternEntryHi);
     }
-    return false;
+    return PatternDecoder::decode(patternEntryLo, patternEntryHi);
 }
 
 // Gets the difference between the given scanline and the y-position of the sprite's top edge
@@ -131,24 +97,6 @@ bool Sprite::isYInRange(const unsigned int scanline, const unsigned int spriteHe
     return false;
 }
 
-// Gets the difference between the given pixel and the x-position of the sprite's left edge
-
-unsigned int Sprite::getXDifference(const unsigned int pixel) const {
-    return pixel - xPos;
-}
-
-// Determines whether the sprite is in range of the given pixel (i.e., if any column of the sprite's
-// tile can be outputted on the scanline)
-
-bool Sprite::isXInRange(const unsigned int pixel) const {
-    const unsigned int xDiff = getXDifference(pixel);
-    const unsigned int spriteWidth = 8;
-    if (xDiff <= spriteWidth - 1) {
-        return true;
-    }
-    return false;
-}
-
 uint8_t Sprite::getUpperPalette() const {
     return attributes & 3;
 }
@@ -3,6 +3,8 @@
 
 #include <cstdint>
 
+#include "pattern-decoder.h"
+
 class Sprite {
     public:
         Sprite();
@@ -36,14 +38,11 @@ class Sprite {
         uint8_t getTileRowIndex(const unsigned int scanline, const unsigned int spriteHeight) const;
 
         // Rendering
-        uint8_t getPalette(const unsigned int pixel) const;
-        bool isChosen(const uint8_t bgPalette, const uint8_t spritePalette) const;
+        uint64_t decodeTileRow() const;
 
         // Locating the Sprite in the Frame
         unsigned int getYDifference(const unsigned int scanline) const;
         bool isYInRange(const unsigned int scanline, const unsigned int spriteHeight) const;
-        unsigned int getXDifference(const unsigned int pixel) const;
-        bool isXInRange(const unsigned int pixel) const;
 
         // Attribute Getters
         uint8_t getUpperPalette() const;